@@ -0,0 +1,71 @@
+#pragma once
+#include "Highlighter.hpp"
+#include "Encoding.hpp"
+#include "JobSystem.hpp"
+
+// Bracket nesting of a document. Each line is summarized as its net depth
+// change and the lowest depth reached inside it (brackets in strings and
+// comments are skipped), and the summaries sit in a segment tree so
+// "matching bracket" and "enclosing opener" are O(log n) plus one line scan.
+// Depth counts every kind alike; a pair found that way whose kinds differ,
+// like '(' closed by ']', is reported as no match.
+// Lines longer than Config::MAX_SCANNED_LINE count as bracket-free, so
+// editing or moving through a minified file never rescans megabytes.
+// A paste's lines are summarized on a worker; until they land the index
+// answers no matches.
+class BracketIndex {
+private:
+    struct Bracket {
+        int col;
+        char ch;                         // the bracket itself, so a pair's kinds can be checked
+        int delta;
+        int depthBefore;
+    };
+
+    std::vector<int> delta;              // per line
+    std::vector<int> minPrefix;          // per line, relative to line start, includes 0
+    std::vector<unsigned char> exitState;
+    int cap = 0;
+    std::vector<int> treeSum, treeMin;
+    bool built = false;
+
+    struct Pending {
+        int first, count;                // where the pasted lines are now
+        int entry;                       // the state they were summarized from
+        std::vector<int> delta, minPrefix;
+        std::vector<unsigned char> exitState;
+        std::atomic<bool> done{false};
+    };
+    std::shared_ptr<Pending> pending;    // zero summaries in the arrays and a stale tree until it lands
+    CancelSource superseded;
+
+    int entryState(int line) const { return line > 0 ? exitState[line - 1] : Highlighter::LEX_CODE; }
+    void summarize(const std::string& text, int line);
+    void setLeaf(int line);
+    void rebuildTree();
+    void rescanFrom(const std::vector<std::string>& lines, int line, bool leaves);
+    void startSummary(int first, std::shared_ptr<const PastedText> pasted);
+    void land(const std::vector<std::string>& lines, bool useResult);
+    int prefix(int line) const;
+    int findFirst(int node, int lo, int hi, int from, int offset, int target) const;
+    int findLast(int node, int lo, int hi, int before, int offset, int target) const;
+    void bracketsIn(const std::string& text, int line, std::vector<Bracket>& out) const;
+    bool openerBefore(const std::vector<std::string>& lines, int row, int col, int depth, int& orow, int& ocol) const;
+
+public:
+    bool isBuilt() const { return built; }
+    void reset(const std::vector<std::string>& lines);
+    void clear();
+    // With pasted, the new lines are summarized from it off the UI thread.
+    void splice(int first, int oldCount, const std::vector<std::string>& lines, int newCount, std::shared_ptr<const PastedText> pasted = nullptr);
+    // Takes in a paste's finished summaries; with now, summarizes the lines
+    // here if the worker hasn't finished.
+    void poll(const std::vector<std::string>& lines, bool now = false);
+
+    bool match(const std::vector<std::string>& lines, int row, int col, int& mrow, int& mcol) const;
+    bool enclosing(const std::vector<std::string>& lines, int row, int col, int& orow, int& ocol) const;
+    static bool isOpen(char c) { return c == '(' || c == '[' || c == '{'; }
+    static bool isClose(char c) { return c == ')' || c == ']' || c == '}'; }
+    static bool isBracket(char c) { return isOpen(c) || isClose(c); }
+    static char partner(char c) { return c == '(' ? ')' : c == ')' ? '(' : c == '[' ? ']' : c == ']' ? '[' : c == '{' ? '}' : c == '}' ? '{' : 0; }
+};
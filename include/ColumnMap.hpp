@@ -0,0 +1,28 @@
+#pragma once
+#include "Globals.hpp"
+#include <map>
+
+// Byte offset of every CHUNK-th codepoint on long lines, so converting
+// between columns and byte offsets starts at the nearest chunk instead of
+// the line start. Offsets are filled in lazily, only as far as a lookup
+// reaches, and an edit keeps the ones before the first byte it changed.
+class ColumnMap {
+private:
+    struct Line {
+        std::vector<size_t> starts{0};   // starts[k] = byte offset of codepoint k * CHUNK
+        bool complete = false;           // starts reaches the last chunk of the line
+    };
+    std::map<int, Line> lines;           // only long lines that have been looked up
+
+    static bool grow(const std::string& text, Line& l);
+
+public:
+    static constexpr size_t LONG_LINE = 16 * 1024;   // bytes; shorter lines are scanned directly
+    static constexpr int CHUNK = 1024;               // codepoints
+
+    int column(const std::string& text, int row, size_t byte);
+    size_t offset(const std::string& text, int row, int col);
+    // Same coordinates as Document::touch; bytes of 'first' before firstCol are unchanged.
+    void splice(int first, int oldCount, int newCount, int firstCol);
+    void clear() { lines.clear(); }
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include "Globals.hpp"
+#include "WrapIndex.hpp"
+#include "BracketIndex.hpp"
+#include "LineDiff.hpp"
+#include "Encoding.hpp"
+#include "ColumnMap.hpp"
+#include <memory>
+#include <atomic>
+#include <deque>
+
+// One undo step holds only the span its edits replaced: it starts keepHead
+// bytes into line first and ends keepTail bytes before the end of the line
+// that has linesAfter lines below it. Both ends are measured so that edits
+// inside the span leave them in place.
+struct UndoState {
+    int row, col;                        // caret to restore
+    int first = 0, keepHead = 0;
+    int linesAfter = 0, keepTail = 0;
+    std::vector<std::string> lines;      // the span's text before the edits; empty until one is noted
+};
+
+// Lines touched since the last commit: [first, oldEnd) before the edits
+// became [first, newEnd) after them. While they all stayed inside one line,
+// fromCol and keepTail bound its changed bytes; fromCol is -1 otherwise.
+// When the only edit was one multi-line paste, pasted holds its text and
+// consumers read the new lines from it instead of copying them.
+struct EditRange {
+    int first = -1;
+    int oldEnd = 0;
+    int newEnd = 0;
+    int fromCol = -1;
+    int keepTail = 0;
+    std::shared_ptr<const PastedText> pasted;
+};
+
+// Where a document's text currently lives. Anything but Resident means
+// lines holds a single empty placeholder line and the tab is read-only.
+enum class Residency : unsigned char { Resident, Packing, Packed, Dropped, Unpacking };
+
+// Text of a hibernated document, handed between the UI and a worker thread.
+struct ParkedText {
+    std::vector<std::string> lines;
+    std::deque<UndoState> undo;
+    std::string blob;            // LZ-compressed lines + undo
+    size_t rawSize = 0;
+    std::string path;            // Dropped: re-read from here instead
+    FileFormat format;           // Dropped: how the file was stored when re-read
+    bool failed = false;
+    std::atomic<bool> done{false};
+};
+
+struct Document {
+    int id = 0;
+    std::string path;
+    std::string filename;
+    std::vector<std::string> lines;
+
+    int row = 0, col = 0;
+    int scroll = 0;
+    int scrollCol = 0;           // first visible column when not wrapping
+    int selRowStart = -1, selColStart = -1;
+    int selRowEnd = -1, selColEnd = -1;
+    bool selecting = false;
+    bool isDirty = false;
+    FileFormat format;
+    std::deque<UndoState> undoStack;
+    EditRange edits;
+    WrapIndex wrap;
+    BracketIndex brackets;
+    LineDiff diff;               // against the saved text
+    mutable ColumnMap columns;   // a cache; const lookups fill it in
+    long long version = 0;       // bumped by every edit
+    bool following = false;      // tail -f: the file's appends come in, edits are refused
+    bool partialView = false;    // lines above settings.followMaxLines were let go; the buffer is no longer the file
+
+    Residency residency = Residency::Resident;
+    std::shared_ptr<ParkedText> parked;
+    size_t bytes = 0;            // resident footprint, recomputed when stale
+    bool bytesStale = true;
+    long long lastActive = 0;
+    CancelSource lifetime;       // cancels this document's queued jobs when it closes
+
+    Document(std::string p = "");
+    void touch(int row, int removed = 1, int inserted = 1, int fromCol = 0, int keepTail = 0);
+    void noteEdit(int r1, int c1, int r2, int c2);   // before replacing that range: keeps its text for undo
+    void insertText(std::shared_ptr<PastedText> text);   // fills in its head and tail
+    bool isResident() const { return residency == Residency::Resident; }
+};
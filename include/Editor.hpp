@@ -1,32 +1,18 @@
 #pragma once
 #include "Globals.hpp"
+#include "Journal.hpp"
+#include "Minimap.hpp"
+#include "Hibernator.hpp"
+#include "WordIndex.hpp"
+#include "SymbolIndex.hpp"
+#include "InputQueue.hpp"
+#include "Follower.hpp"
+#include <memory>
 #include <unordered_set>
-#include <deque>
-
-struct UndoState {
-    std::vector<std::string> lines;
-    int row, col;
-};
-
-struct Document {
-    std::string path;
-    std::string filename;
-    std::vector<std::string> lines;
-    
-    int row = 0, col = 0;
-    int scroll = 0;
-    int selRowStart = -1, selColStart = -1;
-    int selRowEnd = -1, selColEnd = -1;
-    bool selecting = false;
-    bool isDirty = false;
-    std::deque<UndoState> undoStack;
-
-    Document(std::string p = "");
-};
 
 class Editor {
 private:
-    std::vector<Document> docs;
+    std::vector<std::unique_ptr<Document>> docs;   // stable handles: tab moves never touch text
     int activeTab = 0;
     Font font;
     
@@ -35,12 +21,42 @@ private:
     
     float blink = 0;
     bool showCursor = true;
-    float backspaceTimer = 0.0f;
-    float backspaceDelay = 0.35f;
-    float backspaceSpeed = 0.03f;
+    int viewRows = 1;
+    int viewCols = 1;
+    bool gotoOpen = false;
+    std::string gotoInput;
+
+    std::shared_ptr<Highlighter> highlighter = std::make_shared<Highlighter>();
+    Minimap minimap;
+    bool minimapDrag = false;
 
-    std::unordered_set<std::string> keywords;
-    std::unordered_set<std::string> types;
+    int braceRow = -1, braceCol = 0, matchRow = -1, matchCol = 0;
+    int braceDoc = -1;                  // match above is for this doc at braceVersion
+    long long braceVersion = -1;
+    // Closers inserted by auto-bracketing on closerRow; typing one again steps
+    // over it as long as the cursor stays where typing left it (closerAt).
+    int closerDoc = -1, closerRow = 0, closerAt = 0;
+    std::vector<std::pair<int, char>> closers;
+
+    Journal journal;
+    Hibernator hibernator;
+    WordIndex words;
+    std::vector<std::string> completions;
+    int completionDoc = -1;     // popup is open while this is the active doc
+    int completionSel = 0;
+
+    SymbolIndex symbols;
+    std::string lastLookup;
+    int lookupIndex = 0;
+    int jumpDoc = -1, jumpLine = 0;     // go-to-definition target waiting for a tab to restore
+    bool outlineOpen = false;
+    std::vector<SymbolHit> outlineItems;
+    int outlineSel = 0;
+
+    InputQueue input;
+    bool latencyOverlay = false;
+
+    Follower follower;
 
     Document& currentDoc();
     void pushUndo();
@@ -53,17 +69,48 @@ private:
     
     void moveLeft(Document& doc, bool ctrl = false);
     void moveRight(Document& doc, bool ctrl = false);
+    void moveVertical(Document& doc, int dir);
+
+    float gutterWidthFor(const Document& doc);
+    void syncWrap(Document& doc, float textWidth);
+    int visualRow(const Document& doc, int row, int col, size_t* segStart = nullptr);
+    void hitTest(const Document& doc, int vrow, int vcol, int& row, int& col);
+    bool caretPos(const Document& doc, int row, int col, int& vr, float& x);
+    void revealColumn(Document& doc);
+    void syncBrackets(Document& doc);
+    int bracketAtCursor(const Document& doc);
+    void jumpToBracket(Document& doc);
+    int indentOf(const std::string& line);
+    void updateCompletion(Document& doc);
+    void acceptCompletion(Document& doc);
+    std::string wordAt(const Document& doc, int row, int col);
+    void gotoDefinition(const std::string& name);
+    void openOutline();
     
     void deleteCharBackwards();
     void deleteWordBackwards();
     void deleteCharForwards();
     void deleteWordForwards();
 
-    void drawLine(const Document& doc, int lineIdx, int x, int y);
+    void closeTab(int index);
+    bool handleTabBar(Rectangle bounds, Vector2 m);
+    void commitEdits();
+    bool refuseEdit(Document& doc);
+    void applyFollow(Document& doc, FollowChunk& chunk);
+    void spliceFollowed(Document& doc, int first, int oldCount, int newCount, int firstCol = 0);
+    void recoverJournals(const std::string& dir);
+    void handleInput(Rectangle bounds, bool isFocused);
+    void handleKey(Document& doc, const InputEvent& ev);
+    void typeChars(Document& doc, const std::vector<InputEvent>& events, size_t from, size_t to);
+    void handlePointer(Document& doc, Rectangle bounds, const InputEvent& ev);
+    void dragPointer(Document& doc, Rectangle bounds);
+    uint64_t rowSalt = 0;     // theme hash, part of each row's TextBatch key
+    void drawLine(const Document& doc, int lineIdx, int x, int y, int byteStart = 0, int byteEnd = -1);
 
 public:
     Editor();
-    void init(Font f);
+    void init(Font f, const std::string& journalDir = "data/journal");
+    void cleanup();
     void updateFontMetrics();
     void reloadFont(Font f);
     
@@ -74,10 +121,14 @@ public:
 
     std::string getCurrentPath();
     
+    void gotoLine(int line);
+    void toggleFollow();
+    void indexFolder(const std::string& path);
     void selectAll();
     void copyToClipboard();
     void pasteFromClipboard(); 
 
     void update(Rectangle bounds, bool isFocused);
     void render(Rectangle bounds);
+    void endFrame();        // once the frame is presented
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include "Globals.hpp"
+#include <string_view>
+
+enum class TextEncoding : unsigned char { Utf8, Utf8Bom, Utf16LE, Utf16BE, Latin1 };
+enum class LineEnding : unsigned char { LF, CRLF };
+
+// How a file was stored on disk, so saving writes it back the same way.
+struct FileFormat {
+    TextEncoding encoding = TextEncoding::Utf8;
+#ifdef _WIN32
+    LineEnding eol = LineEnding::CRLF;
+#else
+    LineEnding eol = LineEnding::LF;
+#endif
+    bool finalNewline = false;
+    bool bom = false;            // UTF-16: the file started with a byte order mark
+};
+
+// Buffers are always UTF-8 in memory. Detection checks for a BOM, then for
+// the zero-byte pattern of BOM-less UTF-16, then validates UTF-8; anything
+// that isn't valid UTF-8 is read as Latin-1, which round-trips every byte.
+// ASCII runs are validated and transcoded 16 bytes at a time with SSE2.
+const char* EncodingName(TextEncoding enc);
+bool IsValidUtf8(const char* data, size_t len);
+TextEncoding DetectEncoding(const char* data, size_t len);
+std::string DecodeText(const char* data, size_t len, TextEncoding enc);
+// bom only applies to UTF-16; UTF-8 has its own Utf8Bom encoding.
+bool EncodeText(const std::string& utf8, TextEncoding enc, bool bom, std::string& out);
+
+// Whole-file helpers shared by everything that loads a document's text.
+// Lines follow std::getline: a trailing newline doesn't start another line.
+bool ReadTextFile(const std::string& path, std::vector<std::string>& lines, FileFormat& format);
+bool ReadTextFile(const std::string& path, std::vector<std::string>& lines);
+// The whole text in one string, for walking its lines without keeping them.
+bool ReadTextFile(const std::string& path, std::string& text);
+// Falls back to UTF-8 (and updates format) when the text can't be represented.
+bool WriteTextFile(const std::string& path, const std::vector<std::string>& lines, FileFormat& format);
+
+// Text of one multi-line paste. It is shared read-only with the threads that
+// journal and index it, so a bulk paste is handed over once instead of being
+// copied line by line for each of them. The lines it produced are
+// head + body + tail split at '\n', with a '\r' right before one dropped.
+struct PastedText {
+    std::string head, body, tail;
+    int lineCount = 0;
+};
+
+// Calls f(const std::string&) for each line of head + body + tail, split the
+// way PastedText describes, reusing one buffer for every line.
+template <class F> void ForEachLine(std::string_view head, std::string_view body, std::string_view tail, F&& f) {
+    std::string line;
+    size_t p = 0;
+    while (true) {
+        size_t nl = body.find('\n', p);
+        size_t n = (nl == std::string_view::npos ? body.size() : nl) - p;
+        if (nl != std::string_view::npos && n > 0 && body[p + n - 1] == '\r') n--;
+        line.assign(p == 0 ? head : std::string_view()).append(body.substr(p, n));
+        if (nl == std::string_view::npos) { line.append(tail); f(line); return; }
+        f(line);
+        p = nl + 1;
+    }
+}
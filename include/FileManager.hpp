@@ -1,5 +1,6 @@
 #pragma once
 #include "Globals.hpp"
+#include "JobSystem.hpp"
 #include <filesystem>
 
 namespace fs = std::filesystem;
@@ -11,12 +12,20 @@ extern std::string SaveWindowsFileDialog(const char* defaultName = nullptr);
 
 class FileManager {
 private:
+    // Name and type are read once when the directory is listed, not per frame.
+    struct Entry {
+        fs::path path;
+        std::string name;
+        bool isDir;
+    };
     fs::path currentPath;
-    std::vector<fs::directory_entry> entries;
+    std::vector<Entry> entries;
     int scrollIndex = 0;
     float itemHeight = 24.0f;
     std::string selectedFile = "";
+    std::string openedFolder = "";
     bool isLoaded = false;
+    CancelSource listing;   // the directory read in flight, if any
     
     Texture2D folderIcon = { 0 };
 
@@ -28,6 +37,7 @@ public:
     void openFolderDialog();
     void openFileDialog();
     std::string popSelectedFile();
+    std::string popOpenedFolder();
     
     void update(Rectangle bounds, bool isFocused);
     void render(Rectangle bounds, Font font);
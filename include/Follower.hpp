@@ -0,0 +1,69 @@
+#pragma once
+#include "Document.hpp"
+#include <functional>
+
+// What one read of a followed file produced. The bytes are split on '\n':
+// pieces[0] continues the buffer's last line if it was still open, every
+// later piece starts a new line, and an empty final piece means the read
+// ended on a newline.
+struct FollowChunk {
+    bool reset = false;          // truncated or replaced: the pieces replace the buffer
+    bool skippedHead = false;    // reset read only the end of a large file
+    std::vector<std::string> pieces;
+};
+
+// Follows growing files like tail -f. Changes are noticed with inotify on the
+// file's directory (so a rotated-in file under the same name is seen too),
+// plus a periodic stat() for anything that was missed; without inotify the
+// stat() is the only signal. Reads run on a worker and only cover the bytes
+// past what the buffer already holds. A file that shrank or has a new inode
+// is read again from the start, or from its last RESYNC_TAIL bytes.
+class Follower {
+private:
+    struct Read {
+        std::string path;
+        TextEncoding encoding = TextEncoding::Utf8;
+        uint64_t offset = 0, identity = 0;
+        bool verify = false;         // check the buffer's end against the file first
+        bool endsWithNewline = false;
+        FollowChunk chunk;
+        uint64_t next = 0;           // offset after this read
+        bool more = false;           // file has more past MAX_CHUNK
+        bool missing = false;        // mid-rotation; try again later
+        std::atomic<bool> done{false};
+    };
+    struct Watch {
+        int docId = 0;
+        std::string path, name;
+        TextEncoding encoding = TextEncoding::Utf8;
+        uint64_t offset = 0, identity = 0;
+        bool verify = true;
+        bool endsWithNewline = false;
+        bool changed = true;
+        int wd = -1;
+        CancelToken token;
+        std::shared_ptr<Read> read;
+    };
+
+    std::vector<Watch> watches;
+    int notifyFd = -1;
+    float sinceStat = 0.0f;
+
+    static bool statFile(const std::string& path, uint64_t& identity, uint64_t& size);
+    static void run(Read& r);
+    void readEvents();
+
+public:
+    static constexpr size_t MAX_CHUNK = 4 << 20;         // bytes per read
+    static constexpr size_t RESYNC_TAIL = 32 << 20;      // most a reset reads of a large file
+    static constexpr float STAT_INTERVAL = 1.0f;         // seconds, with inotify
+    static constexpr float POLL_INTERVAL = 0.25f;        // seconds, without it
+    static constexpr int TRIM_SLACK = 8;                 // trim once lines exceed the cap by 1/8
+
+    ~Follower();
+    // The buffer must hold exactly what the file had when it was read.
+    void start(const Document& doc);
+    void stop(int docId);
+    // Main thread, once per frame: hands finished reads to apply and starts new ones.
+    void update(float dt, const std::function<void(int docId, FollowChunk& chunk)>& apply);
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include "Globals.hpp"
+#include <memory>
+#include <atomic>
+#include "JobSystem.hpp"
+
+// Baked font atlases (glyph metrics + atlas pixels) cached under data/fontcache,
+// keyed by TTF content hash, size and glyph count. Rasterizing a font that is
+// not cached yet runs on a worker thread; the GPU upload stays on the main thread.
+class FontCache {
+private:
+    struct Baked {
+        int baseSize = 0;
+        int glyphPadding = 0;
+        std::vector<Rectangle> recs;
+        std::vector<GlyphInfo> glyphs;  // image left empty, metrics only
+        int atlasWidth = 0, atlasHeight = 0, atlasFormat = 0;
+        std::vector<unsigned char> pixels;
+    };
+    struct Job {
+        std::string path;
+        int size, glyphCount;
+        std::atomic<bool> done{false};
+        bool ok = false;
+        Baked baked;
+    };
+
+    std::string dir = "data/fontcache";
+    std::shared_ptr<Job> pending;
+    CancelSource superseded;
+
+    // Static so a worker never touches the FontCache instance.
+    static std::string keyFor(const std::string& dir, const std::vector<unsigned char>& ttf, int size, int glyphCount);
+    static bool readCache(const std::string& file, int size, int glyphCount, Baked& out);
+    static void writeCache(const std::string& dir, const std::string& file, const Baked& b);
+    static bool bake(const std::string& dir, const std::string& path, int size, int glyphCount, Baked& out);
+    static Font upload(Baked& b);
+
+public:
+    bool loadCached(const std::string& path, int size, int glyphCount, Font& out);
+    void requestAsync(const std::string& path, int size, int glyphCount);
+    bool isBusy() const { return pending != nullptr; }
+    // Returns true once per finished request; 'failed' is set if the font could not be loaded.
+    bool poll(Font& out, bool& failed);
+};
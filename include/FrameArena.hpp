@@ -0,0 +1,44 @@
+#pragma once
+#include "Globals.hpp"
+#include <memory>
+#include <string_view>
+
+// Bump allocator for text that only has to live until the frame is on
+// screen: labels, line numbers, slices of a line handed to raylib. Blocks
+// are kept across frames, so once the arena has grown to what a frame needs,
+// building UI text costs no heap allocation. A block made larger than
+// BLOCK_SIZE for one big request is freed on reset instead. main() resets it
+// after EndDrawing.
+class FrameArena {
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t current = 0;     // block being filled
+    size_t used = 0;        // bytes taken from blocks[current]
+    size_t total = 0;       // bytes handed out since reset
+
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    char* alloc(size_t bytes);
+    const char* str(std::string_view s);        // NUL-terminated copy
+    const char* format(const char* fmt, ...);
+    void reset();
+    size_t bytesUsed() const { return total; }
+};
+
+extern FrameArena frameArena;
+
+// Heap allocations counted by the replacement operator new in FrameArena.cpp.
+size_t ThreadAllocationCount();      // made by the calling thread
+size_t TotalAllocationCount();       // made by every thread
+
+struct FrameStats {
+    size_t allocations = 0;          // on the main thread
+    size_t allAllocations = 0;       // including workers
+    size_t arenaBytes = 0;
+};
+extern FrameStats frameStats;        // for the last presented frame, filled in by main()
@@ -24,9 +24,14 @@ namespace Config {
     const int FONT_SIZE_UI = 20;
     const int FONT_SIZE_SMALL = 18;
     const int FONT_SIZE_EDITOR_DEFAULT = 24;
+    const int FONT_ATLAS_SIZE = 96;
+    const int FONT_GLYPH_COUNT = 250;
     
     const int ICON_SIZE_SMALL = 20;
     const int ICON_SIZE_LARGE = 64;
+
+    const float SLOW_JOB_MS = 100.0f;   // background jobs slower than this are logged
+    const size_t MAX_SCANNED_LINE = 1 << 20;   // longer lines are skipped by bracket matching and completion
 }
 
 struct Theme {
@@ -80,6 +85,12 @@ struct AppSettings {
     int themeIndex = 0; 
     
     bool showLineNumbers = true;
+    bool wordWrap = false;
+    bool showMinimap = true;
+    int memoryBudgetMB = 512;   // resident text of inactive tabs
+    int keyRepeatDelayMs = 350;
+    int keyRepeatRate = 33;     // repeats per second
+    int followMaxLines = 200000;  // lines a followed file keeps; older ones are let go
 };
 
 struct Toast {
@@ -97,6 +108,9 @@ void ApplyThemePreset(int index);
 void LoadSettings();
 void SaveSettings();
 std::string CodepointToUTF8(int cp);
+bool IsContinuationByte(unsigned char c);
+int Utf8Length(const std::string& s, size_t end = std::string::npos);
+size_t Utf8Offset(const std::string& s, int cp, size_t from = 0);
 
 inline int Clamp(int v, int a, int b) {
     if (v < a) return a;
@@ -0,0 +1,31 @@
+#pragma once
+#include "Document.hpp"
+#include <functional>
+
+// Keeps the text of inactive documents under settings.memoryBudgetMB. The
+// least recently viewed tabs are parked: clean files with no undo history are
+// dropped and re-read from disk, everything else is LZ-compressed together
+// with its undo stack. Packing and restoring both run on worker threads; the
+// UI thread only moves vectors in and out of ParkedText.
+class Hibernator {
+private:
+    long long clock = 0;
+    float timer = 0.0f;
+
+    static size_t footprint(const std::vector<std::string>& lines);
+    static void pack(std::shared_ptr<ParkedText> job);
+    static void unpack(std::shared_ptr<ParkedText> job);
+    static void install(Document& doc, std::vector<std::string>&& lines, std::deque<UndoState>&& undo);
+    static void dropCaches(Document& doc);
+    void park(Document& doc);
+    void wake(Document& doc);
+
+public:
+    static constexpr float CHECK_INTERVAL = 1.0f;
+
+    void markActive(Document& doc) { doc.lastActive = ++clock; }
+    size_t residentBytes(Document& doc);
+    // reread is called for a dropped document once it has been read from disk
+    // again; its format and saved-text diff already describe the new read.
+    void update(std::vector<std::unique_ptr<Document>>& docs, int active, float dt, const std::function<void(Document& doc)>& reread);
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include "Globals.hpp"
+#include <unordered_set>
+#include <string_view>
+
+enum class TokenKind : unsigned char { Text, Keyword, Type, Number, Comment, String, Count };
+
+// Byte range [start, end) of one whitespace-separated word in a line.
+struct TokenSpan {
+    int start, end;
+    TokenKind kind;
+};
+
+// Word-level syntax classification shared by the editor, minimap and workers.
+// Read-only after init(), so worker threads may use it concurrently.
+class Highlighter {
+private:
+    // Views of the literals in init(), so lookups need no temporary string.
+    std::unordered_set<std::string_view> keywords;
+    std::unordered_set<std::string_view> types;
+
+public:
+    void init();
+    TokenKind classify(const char* word, size_t len) const;
+    void tokenize(const std::string& line, std::vector<TokenSpan>& out, size_t maxBytes = std::string::npos) const;
+    static Color colorOf(TokenKind kind);
+
+    // Line lexer state carried across lines (only block comments span lines).
+    enum LexState : int { LEX_CODE = 0, LEX_BLOCK_COMMENT = 1 };
+
+    // Calls onCode(index, ch) for every byte outside strings, char literals and
+    // comments; returns the state the next line starts in.
+    template <typename F>
+    static int scanCode(const std::string& line, int state, F&& onCode) {
+        size_t i = 0, n = line.size();
+        while (i < n) {
+            char c = line[i];
+            if (state == LEX_BLOCK_COMMENT) {
+                if (c == '*' && i + 1 < n && line[i + 1] == '/') { state = LEX_CODE; i += 2; } else i++;
+                continue;
+            }
+            if (c == '/' && i + 1 < n && line[i + 1] == '/') break;
+            if (c == '/' && i + 1 < n && line[i + 1] == '*') { state = LEX_BLOCK_COMMENT; i += 2; continue; }
+            if (c == '"' || c == '\'') {
+                i++;
+                while (i < n && line[i] != c) { if (line[i] == '\\') i++; i++; }
+                i++;
+                continue;
+            }
+            onCode(i, c);
+            i++;
+        }
+        return state;
+    }
+};
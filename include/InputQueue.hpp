@@ -0,0 +1,48 @@
+#pragma once
+#include "Globals.hpp"
+
+struct InputEvent {
+    enum Type : unsigned char { Key, Char, MouseDown, MouseUp, Wheel };
+    Type type;
+    bool repeat;            // synthesized by key repeat
+    bool ctrl, shift;
+    int code;               // key code, codepoint or mouse button
+    float wheel;
+    Vector2 pos;
+    double time;            // when it was read from the window, or when a repeat fell due
+};
+
+// Everything the editor reacts to in a frame, in order. raylib keeps keys,
+// characters and mouse buttons in separate queues, so a character is placed
+// right after the key press that produced it. Held navigation and edit keys
+// repeat at settings.keyRepeatDelayMs / keyRepeatRate. Input latency runs on
+// the wall clock until EndDrawing() returns for the frame that handled the
+// event. raylib can't say when an event arrived, only that it was after the
+// previous poll, so one read from the window is charged at least the time
+// since then; a repeat counts from when it fell due.
+class InputQueue {
+private:
+    static constexpr int REPEAT_KEYS[] = { KEY_LEFT, KEY_RIGHT, KEY_UP, KEY_DOWN, KEY_HOME, KEY_END, KEY_PAGE_UP, KEY_PAGE_DOWN, KEY_BACKSPACE, KEY_DELETE, KEY_ENTER, KEY_TAB };
+    static constexpr int REPEAT_COUNT = sizeof(REPEAT_KEYS) / sizeof(REPEAT_KEYS[0]);
+
+    std::vector<InputEvent> events;
+    double due[REPEAT_COUNT] = {};          // next repeat per held key; 0 when up
+    std::vector<double> unpresented;        // wall-clock start of events handled this frame
+    double lastPoll = 0;                    // wall clock of the previous collect()
+    std::vector<float> latencies;           // ring of recent samples, ms
+    size_t nextSample = 0;
+
+    void push(InputEvent::Type type, int code, double time, bool ctrl, bool shift, bool repeat = false);
+
+public:
+    static constexpr int MAX_REPEATS_PER_FRAME = 8;
+    static constexpr size_t SAMPLE_WINDOW = 1024;
+
+    void collect();
+    void clear();
+    const std::vector<InputEvent>& pending() const { return events; }
+
+    void presented();       // after EndDrawing()
+    size_t sampleCount() const { return latencies.size(); }
+    void percentiles(float& p50, float& p95, float& p99) const;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include "Globals.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <deque>
+#include <chrono>
+
+enum class JobPriority : unsigned char { Interactive, Background };
+
+// Checked by a job before it starts, and by long jobs as they run.
+class CancelToken {
+    std::shared_ptr<const std::atomic<bool>> flag;
+    friend class CancelSource;
+public:
+    bool cancelled() const { return flag && flag->load(std::memory_order_relaxed); }
+};
+
+// Owned by whatever a job works for; destroying or resetting it cancels
+// every token handed out so far.
+class CancelSource {
+    std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+public:
+    CancelSource() = default;
+    CancelSource(const CancelSource&) = delete;
+    CancelSource& operator=(const CancelSource&) = delete;
+    ~CancelSource() { cancel(); }
+    void cancel() { flag->store(true); }
+    void reset() { cancel(); flag = std::make_shared<std::atomic<bool>>(false); }
+    CancelToken token() const { CancelToken t; t.flag = flag; return t; }
+};
+
+struct JobTiming {
+    const char* name;
+    JobPriority priority;
+    float waitMs;           // submitted until started
+    float runMs;
+    bool cancelled;
+};
+
+// Fixed pool of workers, one per hardware thread left after the main thread.
+// Each worker owns a deque per priority lane: it pops its own newest job and,
+// when empty, steals the oldest from the others. Interactive work is always
+// taken first, and background work never occupies the last free worker.
+// A job's completion callback runs on the main thread in drainCompletions(),
+// unless its token was cancelled in the meantime.
+class JobSystem {
+public:
+    using Task = std::function<void()>;
+
+    static JobSystem& instance();
+    ~JobSystem();
+
+    void submit(const char* name, JobPriority priority, Task work, CancelToken token = CancelToken(), Task done = Task());
+    void drainCompletions();
+    void waitIdle();        // until every submitted job has run; completions are left for drainCompletions()
+    void setTimingHook(std::function<void(const JobTiming&)> hook) { timingHook = std::move(hook); }
+    void shutdown();
+    int workerCount() const { return (int)workers.size(); }
+
+private:
+    struct Job {
+        const char* name = "";
+        JobPriority priority = JobPriority::Background;
+        Task work, done;
+        CancelToken token;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+    struct Worker {
+        std::mutex mtx;
+        std::deque<Job> lanes[2];
+        std::thread thread;
+    };
+    struct Finished {
+        Task done;
+        CancelToken token;
+        JobTiming timing;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> nextWorker{0};
+    std::atomic<int> queued{0};
+    std::atomic<int> unfinished{0};     // submitted and not yet run
+    std::atomic<int> backgroundRunning{0};
+    std::mutex sleepMtx;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    bool stopping = false;
+
+    std::mutex finishedMtx;
+    std::vector<Finished> finished;
+    std::function<void(const JobTiming&)> timingHook;
+
+    JobSystem();
+    bool take(int self, Job& out);
+    void run(Job& job);
+    void workerLoop(int self);
+};
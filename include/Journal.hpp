@@ -0,0 +1,82 @@
+#pragma once
+#include "Globals.hpp"
+#include "Encoding.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <cstdio>
+#include <memory>
+
+// Write-ahead log of buffer edits, one file per document under data/journal.
+// The UI thread only serializes records into a pending queue; a writer thread
+// group-commits them every few ms and fsyncs periodically.
+//
+// Files are named <pid>-<random>-<doc>.jnl and stay locked (flock, or an
+// exclusive share mode on Windows) while their instance runs, so a second
+// instance's recover() leaves them alone.
+struct RecoveredDoc {
+    std::string path;
+    std::vector<std::string> lines;
+    std::string journal;    // the file it came from; retire() it once the text is journaled again
+};
+
+class Journal {
+private:
+    struct Op {
+        char type;          // 'O' open, 'S' splice, 'V' saved, 'C' close, 'R' retire
+        int docId;
+        bool fromDisk;
+        std::string data;   // path for O/V/R, serialized splice or byte record for S
+        uint32_t baseLines = 0;
+        uint64_t baseHash = 0;
+        std::shared_ptr<const PastedText> pasted;   // S: written after data, by the writer
+    };
+    struct DocLog {
+        std::string path;
+        bool fromDisk = false;
+        uint32_t baseLines = 0;     // the disk text replay starts from, as LineDiff hashes it
+        uint64_t baseHash = 0;
+        FILE* file = nullptr;
+        bool needsSync = false;
+    };
+
+    std::string dir;
+    std::string session;
+    std::vector<Op> pending;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread writer;
+    bool running = false;
+
+    // Writer-thread state only (recover() fills adopted before the writer starts)
+    std::unordered_map<int, DocLog> logs;
+    std::unordered_map<std::string, FILE*> adopted;     // locks on recovered journals until retired
+
+    void writerLoop();
+    void process(Op& op);
+    void syncAll();
+    std::string fileFor(int docId) const;
+    void push(Op op);
+
+public:
+    float commitInterval = 0.05f;
+    float syncInterval = 1.0f;
+
+    ~Journal();
+    // Journals that don't match the file they were recorded against, or that
+    // fail to replay, are left on disk and listed in kept.
+    std::vector<RecoveredDoc> recover(const std::string& journalDir, std::vector<std::string>& kept);
+    void start(const std::string& journalDir);
+    void stop();
+
+    // fromDisk journals replay on top of the file; baseLines/baseHash describe
+    // the text they start from (LineDiff::savedLines/savedHash).
+    void open(int docId, const std::string& path, bool fromDisk, uint32_t baseLines = 0, uint64_t baseHash = 0);
+    // With pasted, the new lines are its lines and go out as one blob record.
+    void append(int docId, int first, int oldCount, const std::vector<std::string>& lines, int newCount, std::shared_ptr<const PastedText> pasted = nullptr);
+    void appendBytes(int docId, int row, int fromCol, int keepTail, const std::string& line);
+    void saved(int docId, const std::string& path, uint32_t baseLines, uint64_t baseHash);
+    void close(int docId);
+    void retire(const std::string& journalFile);
+};
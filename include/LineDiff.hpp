@@ -0,0 +1,81 @@
+#pragma once
+#include "Globals.hpp"
+#include "Encoding.hpp"
+#include <memory>
+#include <atomic>
+#include "JobSystem.hpp"
+
+// [baseStart, baseStart+baseCount) of the saved text became
+// [curStart, curStart+curCount) of the buffer.
+struct DiffHunk {
+    int baseStart, baseCount;
+    int curStart, curCount;
+};
+
+enum class LineChange : unsigned char { None, Added, Modified, DeletedAbove };
+
+// Line diff of a document against its saved text. Both sides are kept as
+// line hashes only. Edits mark dirty ranges; a worker re-diffs just those
+// windows (widened to the hunks they touch) with Myers on the hashes and
+// the results are spliced back into the hunk list when they land.
+class LineDiff {
+private:
+    struct Window {
+        int curFrom, curTo, baseFrom;
+        std::vector<uint64_t> base, cur;
+        std::vector<DiffHunk> hunks;     // relative to the window
+    };
+    struct Job {
+        std::vector<Window> windows;
+        std::atomic<bool> done{false};
+    };
+    struct Hashing {
+        int first, count;                // where the pasted lines are now
+        std::vector<uint64_t> hashes;
+        std::atomic<bool> done{false};
+    };
+
+    std::vector<uint64_t> base;
+    std::vector<uint64_t> cur;
+    uint64_t baseHash = 0;
+    bool hasBase = false;
+    bool clean = true;
+    std::vector<DiffHunk> hunks;         // sorted by curStart
+
+    std::vector<std::pair<int, int>> dirty;   // current lines not yet re-diffed
+    std::shared_ptr<Job> job;
+    CancelSource superseded;
+    bool jobStale = false;
+    std::shared_ptr<Hashing> hashing;    // a paste's lines, hashed on a worker; 0 in cur until they land
+    CancelSource hashSuperseded;
+
+    static uint64_t hashLine(const std::string& s);
+    static uint64_t hashAll(const std::vector<uint64_t>& hashes);
+    static void run(Window& w);
+    static void mapRange(int& from, int& to, int first, int oldCount, int newCount);
+    void markDirty(int from, int to);
+    void startJob();
+    void startHashing(int first, std::shared_ptr<const PastedText> pasted);
+    void hashNow(const std::vector<std::string>& lines);
+
+public:
+    static constexpr int CONTEXT = 3;
+    static constexpr int MAX_EDIT_DISTANCE = 2000;
+
+    void reset(const std::vector<std::string>& lines);
+    // With pasted, the new lines are hashed from it off the UI thread and
+    // diffed once they land.
+    void splice(int first, int oldCount, const std::vector<std::string>& lines, int newCount, std::shared_ptr<const PastedText> pasted = nullptr);
+    // The saved text changed the same way (a followed file grew or was trimmed).
+    void rebase(int first, int oldCount, const std::vector<std::string>& lines, int newCount);
+    bool poll();                         // true when a result landed
+
+    // What savedHash() would be for this text, for checking a file against it later.
+    static uint64_t textHash(const std::vector<std::string>& lines);
+
+    bool hasBaseline() const { return hasBase; }
+    int savedLines() const { return (int)base.size(); }
+    uint64_t savedHash() const { return baseHash; }
+    bool isClean() const { return clean; }
+    LineChange changeAt(int line) const;
+};
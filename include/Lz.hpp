@@ -0,0 +1,8 @@
+#pragma once
+#include "Globals.hpp"
+
+// Byte-oriented LZ77 codec in the LZ4 style: literal runs and back-references
+// into a 64 KB window, no entropy stage. Fast enough to park and restore
+// documents of hundreds of megabytes without a noticeable pause.
+std::string LzCompress(const char* data, size_t len);
+bool LzDecompress(const std::string& in, std::string& out, size_t rawLen);
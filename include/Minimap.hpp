@@ -0,0 +1,65 @@
+#pragma once
+#include "Highlighter.hpp"
+#include <memory>
+#include <atomic>
+#include "JobSystem.hpp"
+
+// Document overview drawn beside the editor text. Each texture row holds the
+// token colors of one sampled line (one line per row, or one line of each
+// bucket of lines once the document is taller than the strip). Edits repaint
+// only the rows whose line they changed; rows after an edit that added or
+// removed lines move with their lines instead of being repainted. Larger
+// rebuilds are rasterized in tiles on a worker thread.
+class Minimap {
+private:
+    struct Tile {
+        int firstRow = 0;
+        std::vector<int> lines;             // sampled line per row; -1 once an edit replaced it
+        std::vector<std::string> samples;
+        std::vector<Color> pixels;
+        std::atomic<bool> done{false};
+    };
+    struct Job {
+        std::vector<std::unique_ptr<Tile>> tiles;
+        size_t uploaded = 0;
+    };
+
+    Texture2D texture = { 0 };
+    int capacity = 0;       // texture height in rows
+    int docId = -1;
+    int lineCount = 0;
+    int bucket = 1;         // lines per texture row
+    int rows = 0;
+    Color palette[(int)TokenKind::Count] = {};
+
+    std::vector<Color> pixels;          // the texture's contents, so rows can move without repainting
+    std::vector<int> sampled;           // line each texture row shows; -1 if it needs painting
+    bool shifted = false;               // line numbers moved since the rows were matched to buckets
+    bool unpainted = false;             // some row below 'rows' has sampled < 0
+    std::shared_ptr<Job> job;
+    CancelSource superseded;
+    int jobFrom = -1, jobTo = -1;
+
+    static void rasterRow(const std::string& text, const Highlighter& hl, const Color* palette, Color* out);
+    std::string sampleFor(const std::vector<std::string>& lines, int row) const;
+    void paintRow(const std::vector<std::string>& lines, int row, const Highlighter& hl);
+    void uploadRows(int from, int to);
+    void cancelJob();
+    void matchRows();
+    void paintMissing(const std::vector<std::string>& lines, std::shared_ptr<const Highlighter> hl);
+    void scheduleTiles(const std::vector<std::string>& lines, int fromRow, int toRow, std::shared_ptr<const Highlighter> hl);
+    void pollJob();
+    float pixelScale(float height) const { return (rows * 2 <= (int)height) ? 2.0f : 1.0f; }
+
+public:
+    static constexpr int WIDTH = 80;
+    static constexpr int COLS_PER_PIXEL = 2;
+    static constexpr int TILE_ROWS = 256;
+    static constexpr int SYNC_ROWS = 64;
+
+    void onEdit(int id, int first, int oldCount, int newCount);
+    void update(int id, const std::vector<std::string>& lines, int stripHeight, std::shared_ptr<const Highlighter> hl);
+    void render(Rectangle strip, int topLine, int bottomLine);
+    int lineAt(Rectangle strip, float y) const;
+    void unload();
+};
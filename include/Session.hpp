@@ -0,0 +1,139 @@
+#pragma once
+#include "Globals.hpp"
+#include <cstdio>
+#include <bitset>
+
+// Input, time and window size as the main loop sees them. In a normal run
+// these forward to raylib. While a session is recorded or replayed, each
+// frame's input is read once at the top of the frame and served from that
+// snapshot, and time advances by a fixed Session::TIMESTEP per frame, so a
+// replay sees exactly what the recording saw.
+namespace Input {
+    bool IsKeyDown(int key);
+    bool IsKeyPressed(int key);
+    int GetKeyPressed();
+    int GetCharPressed();
+    bool IsMouseButtonDown(int button);
+    bool IsMouseButtonPressed(int button);
+    bool IsMouseButtonReleased(int button);
+    Vector2 GetMousePosition();
+    float GetMouseWheelMove();
+    double GetTime();
+    float GetFrameTime();
+    int GetScreenWidth();
+    int GetScreenHeight();
+    const char* GetClipboardText();
+    void SetClipboardText(const char* text);
+    bool WindowShouldClose();
+}
+
+extern double ThreadCpuMs();            // CPU time of the calling thread
+extern size_t PeakResidentBytes();
+
+// Record/replay of the main loop for end-to-end frame time regressions.
+// A session is a text file: a header, then one block per frame listing only
+// what changed since the previous frame.
+//
+//   ctom-session 1
+//   size 1280 800            window size at the start
+//   open path/to/file        opened before the first frame (any number)
+//   i 30                     30 frames without input changes
+//   f                        one frame, with these changes:
+//   p 65                     key 65 pressed: it goes down and is queued for GetKeyPressed
+//   k 65 0                   key 65 went up (1: down without a press event)
+//   c 97                     character 'a' typed
+//   m 400 300                mouse moved to (400, 300)
+//   b 0 1                    mouse button 0 went down (0: up)
+//   w -3                     wheel moved by -3
+//   r 1024 700               window resized
+//   v text\nmore             clipboard changed outside the editor (\n, \t, \\ escaped)
+//   t paste                  report this frame's CPU time as "paste" (written by hand)
+//   s                        steady state from this frame on: --max-frame-allocs applies (written by hand)
+//
+// Replays start from default settings and an empty journal directory, and
+// wait for background jobs at the top of every frame so their results land
+// in the same frame each run.
+class Session {
+public:
+    enum class Mode : unsigned char { Live, Record, Replay };
+
+    static constexpr float TIMESTEP = 1.0f / Config::FPS_LIMIT;
+    static constexpr int MAX_KEYS = 512;
+    static constexpr int MAX_BUTTONS = 3;
+    static constexpr const char* JOURNAL_DIR = "build/session/journal";
+    static constexpr float REGRESSION_RATIO = 1.25f;     // against the baseline, for p95 frame time and peak RSS
+    static constexpr float REGRESSION_SLACK_MS = 0.5f;   // so sub-millisecond noise is not a regression
+
+    struct FrameInput {
+        std::bitset<MAX_KEYS> keys;
+        bool buttons[MAX_BUTTONS] = {};
+        Vector2 mouse = {0, 0};
+        float wheel = 0;
+        int width = Config::WIN_WIDTH_DEFAULT, height = Config::WIN_HEIGHT_DEFAULT;
+        std::vector<int> pressedKeys, chars;    // queues, in order
+    };
+
+    ~Session() { close(); }
+
+    bool record(const std::string& path, const std::vector<std::string>& files);
+    bool replay(const std::string& path);
+    void setHashOutput(const std::string& path) { hashPath = path; }
+    void setMaxFrameAllocs(long long n) { maxFrameAllocs = n; }
+    void close();
+
+    Mode mode() const { return current; }
+    bool active() const { return current != Mode::Live; }
+    int startWidth() const { return initial.width; }
+    int startHeight() const { return initial.height; }
+    const std::vector<std::string>& startFiles() const { return files; }
+
+    void beginFrame();      // top of the frame, before anything reads input
+    void endFrame();        // after the last draw call, before EndDrawing()
+    void frameAllocated(size_t allocations);     // after EndDrawing(): the frame's main-thread allocations
+    bool finished() const { return current == Mode::Replay && frame + 1 >= (long long)frames.size(); }
+
+    // Prints frame CPU time percentiles, tagged frames and peak RSS. With a baseline file,
+    // compares against this session's line in it (appending one if there is
+    // none); returns false on a regression, or if a steady frame allocated
+    // more than the --max-frame-allocs limit.
+    bool report(const std::string& baselinePath);
+
+    // Read by the Input functions.
+    FrameInput in, prev;
+    size_t nextKey = 0, nextChar = 0;
+    long long frame = -1;
+    std::string clipboard;
+    void clipboardRead(const char* text);
+
+private:
+    struct Change {
+        char op;
+        int a = 0, b = 0;
+        float x = 0, y = 0;
+        std::string text;
+    };
+
+    Mode current = Mode::Live;
+    std::string name;
+    FrameInput initial;
+    std::vector<std::string> files;
+    std::vector<std::vector<Change>> frames;    // replay
+    std::vector<std::pair<long long, std::string>> tags;   // replay: frames reported by name
+    FILE* out = nullptr;                        // record
+    std::string block;                          // record: changes in the frame being run
+    int idleFrames = 0;                         // record: frames without changes, not yet written
+    std::string hashPath;
+    FILE* hashes = nullptr;
+    double frameStart = 0;
+    std::vector<float> cpuMs;
+    std::vector<size_t> allocations;            // replay: main-thread heap allocations per frame
+    long long maxFrameAllocs = -1;              // -1: not checked
+    long long steadyFrom = 0;
+
+    void prepare();
+    void capture();
+    void flushFrame();
+    void apply(const std::vector<Change>& changes);
+};
+
+extern Session session;
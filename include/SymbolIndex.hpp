@@ -0,0 +1,94 @@
+#pragma once
+#include "Globals.hpp"
+#include <memory>
+#include <atomic>
+#include "JobSystem.hpp"
+
+// External platform functions
+extern const char* MapFileReadOnly(const std::string& path, size_t& size, void*& handle);
+extern void UnmapFile(const char* data, size_t size, void* handle);
+
+struct SymbolHit {
+    std::string name;
+    std::string path;
+    int line;
+    char kind;      // 'f' function, 'c' class, 's' struct, 'u' union, 'e' enum, 'n' namespace, 'd' macro
+};
+
+// Definitions found under the opened folder by a lightweight C/C++ tag
+// parser. The index lives in data/symbols as one flat file that is memory
+// mapped for lookups: symbols sorted by name for go-to-definition, plus a
+// per-file list in line order for the outline. A rebuild runs on a worker
+// thread and re-parses only files whose mtime or size changed; the rest are
+// copied from the previous index.
+class SymbolIndex {
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t fileCount;
+        uint32_t symbolCount;
+        uint32_t stringBytes;
+        uint32_t reserved[3];
+    };
+    struct FileRec {
+        int64_t mtime;
+        uint64_t size;
+        uint32_t pathOff, pathLen;
+        uint32_t first, count;      // range in the by-file list
+    };
+    struct SymRec {
+        uint32_t nameOff, nameLen;
+        uint32_t file;
+        uint32_t line;
+        uint32_t kind;
+    };
+    struct Job {
+        std::string root;
+        std::string indexPath;
+        std::string tmpPath;
+        int parsed = 0, reused = 0;
+        bool ok = false;
+        CancelToken cancel;
+        std::atomic<bool> done{false};
+    };
+
+    std::string root;
+    std::string indexPath;
+    const char* data = nullptr;
+    size_t size = 0;
+    void* handle = nullptr;
+    std::shared_ptr<Job> job;
+    CancelSource scan;           // reset by close() so an abandoned build stops early
+    bool rescanQueued = false;
+    float rescanTimer = 0.0f;
+
+    const Header* header() const { return (const Header*)data; }
+    const FileRec* files() const { return (const FileRec*)(data + sizeof(Header)); }
+    const SymRec* symbols() const { return (const SymRec*)(files() + header()->fileCount); }
+    const uint32_t* byFile() const { return (const uint32_t*)(symbols() + header()->symbolCount); }
+    const char* strings() const { return (const char*)(byFile() + header()->symbolCount); }
+    SymbolHit hitFor(const SymRec& s) const;
+
+    static bool valid(const char* data, size_t size);
+    static void build(std::shared_ptr<Job> job);
+    void map();
+    void unmap();
+    void startJob();
+
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr float RESCAN_INTERVAL = 30.0f;
+
+    ~SymbolIndex();
+    static std::string normalize(const std::string& path);
+
+    void open(const std::string& folder);
+    void fileChanged(const std::string& path);
+    void update(float dt);
+    void close();
+
+    bool isReady() const { return data != nullptr; }
+    void find(const std::string& name, std::vector<SymbolHit>& out) const;
+    void outline(const std::string& path, std::vector<SymbolHit>& out) const;
+};
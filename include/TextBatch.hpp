@@ -0,0 +1,70 @@
+#pragma once
+#include "Globals.hpp"
+#include <string_view>
+#include <unordered_map>
+
+// Queues glyph quads for a frame and submits each font atlas's quads as one
+// textured run through rlgl, instead of a DrawTextEx call (and a glyph search)
+// per word. Glyphs are placed exactly as DrawTextEx places them.
+//
+// Rows can be cached: a row drawn between a missed reuseRow(key) and endRow()
+// keeps its quads, and the next frame that asks for the same key gets them
+// back without decoding or looking up a glyph. Keys must cover everything
+// that decides the row's look (text, position, font, size, colors).
+//
+// Queued quads are only drawn by flush(), so flush before drawing anything
+// that must cover the text, and before the scissor rectangle changes.
+class TextBatch {
+public:
+    struct Stats {
+        size_t calls = 0;       // text() calls, i.e. DrawTextEx calls replaced
+        size_t quads = 0;
+        size_t draws = 0;       // textured runs handed to rlgl
+        size_t rowsReused = 0, rowsBuilt = 0;
+    };
+
+    static constexpr int LOOKUP_SIZE = 512;     // codepoints with a direct glyph index
+    static constexpr size_t RUN_QUADS = 1024;   // quads checked against the rlgl batch at a time
+
+    // Returns the pen advance, including 'spacing' after the last glyph.
+    float text(const Font& font, std::string_view s, Vector2 pos, float size, float spacing, Color color);
+    bool reuseRow(uint64_t key);
+    void endRow();
+    void flush();
+    void endFrame();            // drops cached rows that were not drawn this frame
+
+    const Stats& lastFrame() const { return last; }
+    static uint64_t rowKey(std::string_view text, Vector2 pos, const Font& font, float size, uint64_t salt);
+
+private:
+    struct Quad {
+        float x0, y0, x1, y1;
+        float u0, v0, u1, v1;
+        Color color;
+    };
+    struct Atlas {
+        unsigned int texture = 0;
+        const GlyphInfo* glyphs = nullptr;
+        int lookup[LOOKUP_SIZE];
+        std::vector<Quad> quads;
+    };
+    struct Row {
+        unsigned int texture = 0;
+        std::vector<Quad> quads;
+        long long frame = 0;
+    };
+
+    std::vector<Atlas> atlases;
+    std::unordered_map<uint64_t, Row> rows;
+    std::vector<std::unordered_map<uint64_t, Row>::node_type> spare;   // dropped rows, reused so scrolling doesn't allocate
+    long long frame = 0;
+    bool rowOpen = false;
+    uint64_t openKey = 0;
+    int openAtlas = -1;
+    size_t openStart = 0;
+    Stats current, last;
+
+    Atlas& atlasFor(const Font& font, int& index);
+};
+
+extern TextBatch textBatch;
@@ -0,0 +1,96 @@
+#pragma once
+#include "Globals.hpp"
+#include "Encoding.hpp"
+#include "JobSystem.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <string_view>
+#include <memory>
+#include <deque>
+
+// Identifier frequencies across open documents and the opened folder, for
+// completion. The UI thread only queues line splices; a worker thread keeps
+// the counts and publishes a sorted snapshot, so queries never wait on it
+// (they may see results a few edits old). A folder is scanned by a background
+// job and its counts merged in one command, so splices never queue behind it.
+class WordIndex {
+private:
+    struct Command {
+        char type;          // 'L' load file, 'S' splice, 'C' close, 'F' folder counts
+        int docId;
+        int first, oldCount;
+        std::vector<std::string> lines;
+        std::string path;
+        std::shared_ptr<const PastedText> pasted;   // 'S': the new lines, instead of lines
+        std::unordered_map<std::string, uint32_t> folderWords;
+    };
+    struct Entry {
+        const std::string* word;
+        uint32_t count;
+    };
+    struct Snapshot {
+        std::vector<Entry> entries;   // sorted by word, count > 0
+    };
+
+    std::vector<Command> pending;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread worker;
+    bool running = false;
+    CancelSource folderScan;
+
+    std::mutex snapMtx;
+    std::shared_ptr<const Snapshot> snapshot;
+
+    // Worker-thread state only. Words are never erased, so the pointers in
+    // published snapshots stay valid for the life of the index.
+    std::deque<std::string> words;
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> sorted;         // ids in word order
+    std::vector<uint32_t> fresh;          // ids not yet merged into sorted
+    // A document's word ids: each line's are one run in pool. Runs an edit
+    // replaced stay in pool as garbage until it outweighs the live ones.
+    struct DocWords {
+        std::vector<uint32_t> pool;
+        std::vector<std::pair<uint32_t, uint32_t>> runs;   // per line: start, count
+        size_t garbage = 0;
+    };
+    std::unordered_map<int, DocWords> docLines;
+    std::unordered_map<uint32_t, uint32_t> folderCounts;
+    bool changed = false;
+
+    void workerLoop();
+    void process(Command& cmd);
+    void scanLine(const std::string& line, std::vector<uint32_t>& out);
+    std::pair<uint32_t, uint32_t> addRun(DocWords& doc, const std::string& line);
+    static void compact(DocWords& doc);
+    uint32_t intern(std::string_view word);
+    void mergeFolder(std::unordered_map<std::string, uint32_t>& found);
+    static void scanFolder(const std::string& path, std::unordered_map<std::string, uint32_t>& found, const CancelToken& token);
+    void publish();
+    void push(Command cmd);
+
+public:
+    static constexpr int MIN_WORD = 3;
+    static constexpr int MAX_WORD = 64;
+    static constexpr size_t MAX_FILE_BYTES = 4 << 20;
+    static constexpr int SCAN_LIMIT = 50000;
+    float publishInterval = 0.1f;
+
+    ~WordIndex();
+    void start();
+    void stop();
+
+    void load(int docId, const std::string& path);
+    // With pasted, the worker reads the new lines from it and nothing is copied.
+    void splice(int docId, int first, int oldCount, const std::vector<std::string>& lines, int newCount, std::shared_ptr<const PastedText> pasted = nullptr);
+    void close(int docId);
+    void addFolder(const std::string& path);   // replaces the last folder's words once the scan lands
+
+    // Best matches for prefix: prefix matches by frequency, then fuzzy
+    // (in-order subsequence) matches. Never blocks on the worker.
+    void complete(const std::string& prefix, std::vector<std::string>& out, size_t maxResults);
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include "Globals.hpp"
+#include <memory>
+#include <atomic>
+#include "JobSystem.hpp"
+#include <unordered_map>
+#include <climits>
+
+// Soft-wrap layout of a document: visual rows per logical line, kept in a
+// Fenwick tree so line <-> visual row lookups are O(log n). A row ends at the
+// last break that fits the width (the editor font is monospaced, so width is
+// a column count): after whitespace, or between a word and punctuation. Only
+// a word longer than the whole row is cut mid-word. Lines that fit need no
+// layout, so a width change only re-lays the longer lines, and for large
+// documents that runs off the UI thread.
+class WrapIndex {
+private:
+    struct Job {
+        int width = 1;
+        std::vector<int> cols;
+        std::vector<std::pair<int, std::string>> wide;   // lines longer than width, copied
+        std::vector<int> rows;
+        std::vector<int> tree;
+        std::atomic<bool> done{false};
+    };
+
+    int wrapWidth = 0;
+    std::vector<int> cols;   // codepoints per line
+    std::vector<int> rows;   // visual rows per line at wrapWidth
+    mutable std::vector<int> tree;   // Fenwick tree over rows, 1-based
+    mutable int staleFrom = INT_MAX; // nodes past this line are rebuilt on the next lookup
+    mutable std::unordered_map<int, std::vector<int>> starts;   // row starts of wrapped lines, filled on demand
+
+    std::shared_ptr<Job> pending;
+    CancelSource superseded;
+    int pendingWidth = 0;
+    long long structureGen = 0;   // bumped when the line count changes
+    long long jobGen = 0;
+    std::vector<int> touchedSinceJob;
+
+    static void buildTree(const std::vector<int>& rows, std::vector<int>& tree);
+    void refreshTree() const;
+    void addRows(int line, int delta);
+    void relayLine(const std::vector<std::string>& lines, int line);
+    void startJob(const std::vector<std::string>& lines);
+    const std::vector<int>& startsOf(const std::string& text, int line) const;
+
+public:
+    static constexpr int ASYNC_THRESHOLD = 50000;
+    static constexpr size_t MAX_CACHED_LINES = 4096;
+
+    bool enabled = false;
+
+    // Rows of one line at a width; fills cols and, if asked, the codepoint where each row starts.
+    static int layout(const std::string& text, int width, int& cols, std::vector<int>* rowStarts = nullptr);
+
+    void reset(const std::vector<std::string>& lines, int width);
+    void clear();
+    void splice(int first, int oldCount, const std::vector<std::string>& lines, int newCount);
+    void requestWidth(const std::vector<std::string>& lines, int width);
+    void poll(const std::vector<std::string>& lines);
+
+    bool isBuilt() const { return wrapWidth > 0; }
+    int width() const { return wrapWidth; }
+    int targetWidth() const { return pending ? pendingWidth : wrapWidth; }
+    int lineCount() const { return (int)rows.size(); }
+    int totalRows() const;
+    int rowsOf(int line) const { return (line >= 0 && line < (int)rows.size()) ? rows[line] : 1; }
+    int rowOfLine(int line) const;
+    void find(int visualRow, int& line, int& sub) const;
+    // Codepoint columns: where row 'sub' of a line starts, and which row a column is drawn on.
+    int rowStart(const std::string& text, int line, int sub) const;
+    int rowEnd(const std::string& text, int line, int sub) const;
+    int subRowOf(const std::string& text, int line, int col) const;
+};
@@ -0,0 +1,232 @@
+#include "../include/BracketIndex.hpp"
+
+// Net depth change and lowest depth of a line entered in state entry; returns the state it exits in.
+static int Summarize(const std::string& text, int entry, int& delta, int& minPrefix) {
+    int d = 0, mn = 0;
+    if (text.size() <= Config::MAX_SCANNED_LINE) {
+        entry = Highlighter::scanCode(text, entry, [&](size_t, char c) {
+            if (BracketIndex::isOpen(c)) d++;
+            else if (BracketIndex::isClose(c)) { d--; if (d < mn) mn = d; }
+        });
+    }
+    delta = d; minPrefix = mn;
+    return entry;
+}
+
+void BracketIndex::summarize(const std::string& text, int line) {
+    exitState[line] = (unsigned char)Summarize(text, entryState(line), delta[line], minPrefix[line]);
+}
+
+void BracketIndex::setLeaf(int line) {
+    int i = cap + line;
+    treeSum[i] = delta[line]; treeMin[i] = minPrefix[line];
+    for (i >>= 1; i > 0; i >>= 1) {
+        treeSum[i] = treeSum[2 * i] + treeSum[2 * i + 1];
+        treeMin[i] = std::min(treeMin[2 * i], treeSum[2 * i] + treeMin[2 * i + 1]);
+    }
+}
+
+void BracketIndex::rebuildTree() {
+    int n = (int)delta.size();
+    cap = 1;
+    while (cap < n) cap <<= 1;
+    treeSum.assign(2 * cap, 0); treeMin.assign(2 * cap, 0);
+    for (int i = 0; i < n; i++) { treeSum[cap + i] = delta[i]; treeMin[cap + i] = minPrefix[i]; }
+    for (int i = cap - 1; i > 0; i--) {
+        treeSum[i] = treeSum[2 * i] + treeSum[2 * i + 1];
+        treeMin[i] = std::min(treeMin[2 * i], treeSum[2 * i] + treeMin[2 * i + 1]);
+    }
+}
+
+void BracketIndex::clear() {
+    delta.clear(); minPrefix.clear(); exitState.clear();
+    treeSum.clear(); treeMin.clear(); cap = 0; built = false;
+    pending.reset(); superseded.reset();
+}
+
+void BracketIndex::reset(const std::vector<std::string>& lines) {
+    pending.reset(); superseded.reset();
+    int n = (int)lines.size();
+    delta.assign(n, 0); minPrefix.assign(n, 0); exitState.assign(n, Highlighter::LEX_CODE);
+    for (int i = 0; i < n; i++) summarize(lines[i], i);
+    rebuildTree();
+    built = true;
+}
+
+// Lines from 'line' on are rescanned only while the block-comment state
+// handed to them keeps changing.
+void BracketIndex::rescanFrom(const std::vector<std::string>& lines, int line, bool leaves) {
+    for (int n = (int)lines.size(); line < n; line++) {
+        unsigned char before = exitState[line];
+        summarize(lines[line], line);
+        if (leaves) setLeaf(line);
+        if (exitState[line] == before) break;
+    }
+}
+
+// Same coordinates as Document::edits.
+void BracketIndex::splice(int first, int oldCount, const std::vector<std::string>& lines, int newCount, std::shared_ptr<const PastedText> pasted) {
+    if (!built) return;
+    int oldLast = first + oldCount - 1;
+    int oldTailExit = (oldCount > 0 && oldLast < (int)exitState.size()) ? exitState[oldLast] : entryState(first);
+    bool structural = oldCount != newCount;
+    if (structural) {
+        delta.erase(delta.begin() + first, delta.begin() + first + oldCount);
+        minPrefix.erase(minPrefix.begin() + first, minPrefix.begin() + first + oldCount);
+        exitState.erase(exitState.begin() + first, exitState.begin() + first + oldCount);
+        delta.insert(delta.begin() + first, newCount, 0);
+        minPrefix.insert(minPrefix.begin() + first, newCount, 0);
+        exitState.insert(exitState.begin() + first, newCount, (unsigned char)Highlighter::LEX_CODE);
+    }
+    // Pasted lines still being summarized move with the edit, unless it
+    // reaches into them or another paste comes in; then they are done here.
+    if (pending) {
+        int oldEnd = first + oldCount, d = newCount - oldCount;
+        int from = pending->first, to = from + pending->count;
+        bool overlaps = from < oldEnd && to > first;
+        pending->first = from < first ? from : (from >= oldEnd ? from + d : first);
+        pending->count = (to <= first ? to : (to >= oldEnd ? to + d : first + newCount)) - pending->first;
+        if (overlaps) land(lines, false);
+        else if (pasted) poll(lines, true);
+    }
+    if (pasted) {
+        startSummary(first, std::move(pasted));
+        return;
+    }
+    // While a paste is pending the tree goes unused; it is rebuilt when the paste lands.
+    bool leaves = !structural && !pending;
+    int n = (int)lines.size();
+    int end = first + newCount;
+    for (int line = first; line < end && line < n; line++) { summarize(lines[line], line); if (leaves) setLeaf(line); }
+    int handedOn = end > 0 ? exitState[end - 1] : Highlighter::LEX_CODE;
+    if (handedOn != oldTailExit) rescanFrom(lines, end, leaves);
+    if (structural && !pending) rebuildTree();
+}
+
+void BracketIndex::startSummary(int first, std::shared_ptr<const PastedText> pasted) {
+    std::shared_ptr<Pending> p = std::make_shared<Pending>();
+    p->first = first;
+    p->count = pasted->lineCount;
+    p->entry = entryState(first);
+    pending = p;
+    JobSystem::instance().submit("brackets.paste", JobPriority::Interactive, [p, pasted, n = p->count, entry = p->entry]() {
+        p->delta.resize(n); p->minPrefix.resize(n); p->exitState.resize(n);
+        int state = entry, i = 0;
+        ForEachLine(pasted->head, pasted->body, pasted->tail, [&](const std::string& line) {
+            state = Summarize(line, state, p->delta[i], p->minPrefix[i]);
+            p->exitState[i++] = (unsigned char)state;
+        });
+        p->done = true;
+    }, superseded.token());
+}
+
+// The worker's summaries only fit while the lines before still hand over
+// the state they were computed from.
+void BracketIndex::land(const std::vector<std::string>& lines, bool useResult) {
+    std::shared_ptr<Pending> p = std::move(pending);
+    superseded.reset();
+    int end = p->first + p->count;
+    if (useResult && entryState(p->first) == p->entry) {
+        std::copy(p->delta.begin(), p->delta.end(), delta.begin() + p->first);
+        std::copy(p->minPrefix.begin(), p->minPrefix.end(), minPrefix.begin() + p->first);
+        std::copy(p->exitState.begin(), p->exitState.end(), exitState.begin() + p->first);
+    } else for (int line = p->first; line < end; line++) summarize(lines[line], line);
+    rescanFrom(lines, end, false);
+    rebuildTree();
+}
+
+void BracketIndex::poll(const std::vector<std::string>& lines, bool now) {
+    if (pending && (now || pending->done)) land(lines, pending->done);
+}
+
+int BracketIndex::prefix(int line) const {
+    int sum = 0;
+    for (int l = cap, r = cap + line; l < r; l >>= 1, r >>= 1) {
+        if (l & 1) sum += treeSum[l++];
+        if (r & 1) sum += treeSum[--r];
+    }
+    return sum;
+}
+
+// First line >= from whose lowest depth reaches target. offset is the depth at lo.
+int BracketIndex::findFirst(int node, int lo, int hi, int from, int offset, int target) const {
+    if (hi <= from) return -1;
+    if (lo >= from && offset + treeMin[node] > target) return -1;
+    if (hi - lo == 1) return lo;
+    int mid = (lo + hi) / 2;
+    int r = findFirst(2 * node, lo, mid, from, offset, target);
+    if (r >= 0) return r;
+    return findFirst(2 * node + 1, mid, hi, from, offset + treeSum[2 * node], target);
+}
+
+// Last line < before whose lowest depth reaches target.
+int BracketIndex::findLast(int node, int lo, int hi, int before, int offset, int target) const {
+    if (lo >= before) return -1;
+    if (hi <= before && offset + treeMin[node] > target) return -1;
+    if (hi - lo == 1) return lo;
+    int mid = (lo + hi) / 2;
+    int r = findLast(2 * node + 1, mid, hi, before, offset + treeSum[2 * node], target);
+    if (r >= 0) return r;
+    return findLast(2 * node, lo, mid, before, offset, target);
+}
+
+void BracketIndex::bracketsIn(const std::string& text, int line, std::vector<Bracket>& out) const {
+    out.clear();
+    if (text.size() > Config::MAX_SCANNED_LINE) return;
+    int depth = prefix(line);
+    Highlighter::scanCode(text, entryState(line), [&](size_t i, char c) {
+        if (isOpen(c)) { out.push_back({(int)i, c, 1, depth}); depth++; }
+        else if (isClose(c)) { out.push_back({(int)i, c, -1, depth}); depth--; }
+    });
+}
+
+// Nearest opener before (row, col) that the position at 'depth' is nested in.
+bool BracketIndex::openerBefore(const std::vector<std::string>& lines, int row, int col, int depth, int& orow, int& ocol) const {
+    std::vector<Bracket> bs;
+    bracketsIn(lines[row], row, bs);
+    for (int i = (int)bs.size() - 1; i >= 0; i--) {
+        if (bs[i].col < col && bs[i].delta > 0 && bs[i].depthBefore <= depth - 1) { orow = row; ocol = bs[i].col; return true; }
+    }
+    int line = findLast(1, 0, cap, row, 0, depth - 1);
+    if (line < 0) return false;
+    bracketsIn(lines[line], line, bs);
+    for (int i = (int)bs.size() - 1; i >= 0; i--) {
+        if (bs[i].delta > 0 && bs[i].depthBefore <= depth - 1) { orow = line; ocol = bs[i].col; return true; }
+    }
+    return false;
+}
+
+bool BracketIndex::match(const std::vector<std::string>& lines, int row, int col, int& mrow, int& mcol) const {
+    int n = (int)lines.size();
+    if (!built || pending || n != (int)delta.size() || row < 0 || row >= n) return false;
+    std::vector<Bracket> bs;
+    bracketsIn(lines[row], row, bs);
+    int k = -1;
+    for (int i = 0; i < (int)bs.size(); i++) if (bs[i].col == col) { k = i; break; }
+    if (k < 0) return false;
+    char want = partner(bs[k].ch);
+    if (bs[k].delta < 0) return openerBefore(lines, row, col, bs[k].depthBefore, mrow, mcol) && lines[mrow][mcol] == want;
+
+    int outer = bs[k].depthBefore;
+    for (int i = k + 1; i < (int)bs.size(); i++) {
+        if (bs[i].depthBefore + bs[i].delta <= outer) { mrow = row; mcol = bs[i].col; return bs[i].ch == want; }
+    }
+    int line = findFirst(1, 0, cap, row + 1, 0, outer);
+    if (line < 0 || line >= n) return false;
+    bracketsIn(lines[line], line, bs);
+    for (const Bracket& b : bs) {
+        if (b.depthBefore + b.delta <= outer) { mrow = line; mcol = b.col; return b.ch == want; }
+    }
+    return false;
+}
+
+bool BracketIndex::enclosing(const std::vector<std::string>& lines, int row, int col, int& orow, int& ocol) const {
+    int n = (int)lines.size();
+    if (!built || pending || n != (int)delta.size() || row < 0 || row >= n) return false;
+    std::vector<Bracket> bs;
+    bracketsIn(lines[row], row, bs);
+    int depth = prefix(row);
+    for (const Bracket& b : bs) if (b.col < col) depth = b.depthBefore + b.delta;
+    if (depth <= 0) return false;
+    return openerBefore(lines, row, col, depth, orow, ocol);
+}
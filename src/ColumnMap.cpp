@@ -0,0 +1,68 @@
+#include "../include/ColumnMap.hpp"
+#include <cstring>
+
+static int CountCodepoints(const std::string& text, size_t from, size_t to) {
+    int n = 0;
+    for (size_t i = from; i < to; i++) if (!IsContinuationByte(text[i])) n++;
+    return n;
+}
+
+// Finds the next chunk start eight bytes at a time: a byte starts a codepoint
+// unless its top bits are 10.
+bool ColumnMap::grow(const std::string& text, Line& l) {
+    if (l.complete) return false;
+    const char* p = text.data();
+    size_t n = text.size(), i = l.starts.back();
+    int need = CHUNK + 1;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        uint64_t lead = ~(w & ~(w << 1)) & 0x8080808080808080ull;
+        int count = (int)(((lead >> 7) * 0x0101010101010101ull) >> 56);
+        if (count >= need) break;
+        need -= count;
+    }
+    for (; i < n; i++) if (!IsContinuationByte(p[i]) && --need == 0) break;
+    if (i >= n) { l.complete = true; return false; }
+    l.starts.push_back(i);
+    return true;
+}
+
+int ColumnMap::column(const std::string& text, int row, size_t byte) {
+    byte = std::min(byte, text.size());
+    if (text.size() < LONG_LINE) return Utf8Length(text, byte);
+    Line& l = lines[row];
+    while (l.starts.back() < byte && grow(text, l)) {}
+    size_t k = std::upper_bound(l.starts.begin(), l.starts.end(), byte) - l.starts.begin() - 1;
+    return (int)k * CHUNK + CountCodepoints(text, l.starts[k], byte);
+}
+
+size_t ColumnMap::offset(const std::string& text, int row, int col) {
+    col = std::max(0, col);
+    if (text.size() < LONG_LINE) return Utf8Offset(text, col);
+    Line& l = lines[row];
+    while ((int)l.starts.size() <= col / CHUNK && grow(text, l)) {}
+    size_t k = std::min((size_t)(col / CHUNK), l.starts.size() - 1);
+    return Utf8Offset(text, col - (int)k * CHUNK, l.starts[k]);
+}
+
+void ColumnMap::splice(int first, int oldCount, int newCount, int firstCol) {
+    if (lines.empty()) return;
+    auto keepPrefix = [firstCol](Line& l) {
+        while (l.starts.size() > 1 && l.starts.back() >= (size_t)firstCol) l.starts.pop_back();
+        l.complete = false;
+    };
+    if (oldCount == newCount) {
+        auto it = lines.lower_bound(first);
+        if (it != lines.end() && it->first == first && firstCol > 0) { keepPrefix(it->second); ++it; }
+        while (it != lines.end() && it->first < first + oldCount) it = lines.erase(it);
+        return;
+    }
+    std::map<int, Line> shifted;
+    for (auto& [row, l] : lines) {
+        if (row < first) shifted.emplace_hint(shifted.end(), row, std::move(l));
+        else if (row == first && firstCol > 0) { keepPrefix(l); shifted.emplace_hint(shifted.end(), row, std::move(l)); }
+        else if (row >= first + oldCount) shifted.emplace_hint(shifted.end(), row + newCount - oldCount, std::move(l));
+    }
+    lines.swap(shifted);
+}
@@ -1,7 +1,11 @@
 #include "../include/Editor.hpp"
 #include "../include/FileManager.hpp" 
+#include "../include/FrameArena.hpp"
+#include "../include/Session.hpp"
+#include "../include/TextBatch.hpp"
 #include <fstream>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 
 Theme theme; 
@@ -17,6 +21,8 @@ std::string CodepointToUTF8(int cp) {
     return res;
 }
 bool IsContinuationByte(unsigned char c) { return (c & 0xC0) == 0x80; }
+int Utf8Length(const std::string& s, size_t end) { if (end > s.size()) end = s.size(); int n = 0; for (size_t i = 0; i < end; i++) if (!IsContinuationByte(s[i])) n++; return n; }
+size_t Utf8Offset(const std::string& s, int cp, size_t from) { size_t i = from; while (i < s.size() && cp > 0) { i++; while (i < s.size() && IsContinuationByte(s[i])) i++; cp--; } return i; }
 bool IsWordChar(char c) { return (isalnum(c) || c == '_'); }
 void ShowToast(const std::string& msg) { toastQueue.push_back({msg, 2.0f, 2.0f}); }
 
@@ -35,6 +41,12 @@ void SaveSettings() {
         out << "showSide=" << settings.showSidebar << "\n";
         out << "showTerm=" << settings.showTerminal << "\n";
         out << "navbarH=" << settings.navbarHeight << "\n";
+        out << "wordWrap=" << settings.wordWrap << "\n";
+        out << "minimap=" << settings.showMinimap << "\n";
+        out << "memoryBudgetMB=" << settings.memoryBudgetMB << "\n";
+        out << "keyRepeatDelayMs=" << settings.keyRepeatDelayMs << "\n";
+        out << "keyRepeatRate=" << settings.keyRepeatRate << "\n";
+        out << "followMaxLines=" << settings.followMaxLines << "\n";
         out.close();
     }
 }
@@ -59,6 +71,12 @@ void LoadSettings() {
         else if (key == "showSide") settings.showSidebar = std::stoi(val);
         else if (key == "showTerm") settings.showTerminal = std::stoi(val);
         else if (key == "navbarH") settings.navbarHeight = std::stoi(val);
+        else if (key == "wordWrap") settings.wordWrap = std::stoi(val);
+        else if (key == "minimap") settings.showMinimap = std::stoi(val);
+        else if (key == "memoryBudgetMB") settings.memoryBudgetMB = std::stoi(val);
+        else if (key == "keyRepeatDelayMs") settings.keyRepeatDelayMs = std::stoi(val);
+        else if (key == "keyRepeatRate") settings.keyRepeatRate = std::stoi(val);
+        else if (key == "followMaxLines") settings.followMaxLines = std::stoi(val);
     }
     if(settings.navbarHeight < 20) settings.navbarHeight = 20;
 }
@@ -75,33 +93,80 @@ void ApplyThemePreset(int index) {
     }
 }
 
-Document::Document(std::string p) : path(p) { if (path.empty()) filename = "Untitled"; else { size_t pos = path.find_last_of("/\\"); filename = (pos == std::string::npos) ? path : path.substr(pos + 1); } lines.push_back(""); }
+static int nextDocId = 0;
+Document::Document(std::string p) : id(++nextDocId), path(p) { if (path.empty()) filename = "Untitled"; else { size_t pos = path.find_last_of("/\\"); filename = (pos == std::string::npos) ? path : path.substr(pos + 1); } lines.push_back(""); diff.reset(lines); }
+// Inserts text at the cursor in one pass: room for the pasted lines is made
+// with a single insert and each is split straight into place, so cost is
+// linear in the text plus the lines after the cursor. A multi-line paste that is the only
+// edit so far is left in edits.pasted for commitEdits to hand on whole.
+void Document::insertText(std::shared_ptr<PastedText> text) { int n = (int)std::count(text->body.begin(), text->body.end(), '\n') + 1; noteEdit(row, col, row, col); int startRow = row, startCol = col; if (n == 1) { lines[row].insert(col, text->body); col += (int)text->body.size(); touch(row, 1, 1, startCol, (int)lines[row].size() - col); return; } text->head = lines[row].substr(0, col); text->tail = lines[row].substr(col); text->lineCount = n; lines[row].erase(col); lines.insert(lines.begin() + row + 1, n - 1, std::string()); int i = 0; ForEachLine("", text->body, "", [&](const std::string& piece) { if (i == 0) lines[row] += piece; else lines[row + i] = piece; i++; }); row += n - 1; col = (int)lines[row].size(); lines[row] += text->tail; touch(startRow, 1, n, startCol); if (edits.first == startRow && edits.newEnd == startRow + n) edits.pasted = std::move(text); }
+void Document::touch(int r, int removed, int inserted, int fromCol, int keepTail) { edits.pasted.reset(); columns.splice(r, removed, inserted, fromCol); version++; bool inLine = removed == 1 && inserted == 1; if (edits.first < 0) { edits.first = r; edits.oldEnd = r + removed; edits.newEnd = r + inserted; edits.fromCol = inLine ? fromCol : -1; edits.keepTail = keepTail; } else { if (edits.fromCol >= 0 && inLine && r == edits.first && edits.oldEnd == r + 1 && edits.newEnd == r + 1) { edits.fromCol = std::min(edits.fromCol, fromCol); edits.keepTail = std::min(edits.keepTail, keepTail); } else edits.fromCol = -1; if (r + removed > edits.newEnd) { edits.oldEnd += r + removed - edits.newEnd; edits.newEnd = r + removed; } if (r < edits.first) edits.first = r; edits.newEnd += inserted - removed; } isDirty = true; bytesStale = true; }
+static std::vector<std::string> TextBetween(const std::vector<std::string>& lines, int r1, int c1, int r2, int c2) { if (r1 == r2) return { lines[r1].substr(c1, c2 - c1) }; std::vector<std::string> out; out.reserve(r2 - r1 + 1); out.push_back(lines[r1].substr(c1)); out.insert(out.end(), lines.begin() + r1 + 1, lines.begin() + r2); out.push_back(lines[r2].substr(0, c2)); return out; }
+static void JoinText(std::vector<std::string>& text, std::vector<std::string>&& after) { text.back() += after.front(); text.insert(text.end(), std::make_move_iterator(after.begin() + 1), std::make_move_iterator(after.end())); }
+// The open undo step grows to cover every range its edits replace; text between two ranges is taken as it is now, which is also how it was before the step.
+void Document::noteEdit(int r1, int c1, int r2, int c2) { if (undoStack.empty()) return; UndoState& u = undoStack.back(); int last = (int)lines.size() - 1; if (u.lines.empty()) { u.first = r1; u.keepHead = c1; u.linesAfter = last - r2; u.keepTail = (int)lines[r2].size() - c2; u.lines = TextBetween(lines, r1, c1, r2, c2); return; } int er = last - u.linesAfter, ec = (int)lines[er].size() - u.keepTail; if (r1 < u.first || (r1 == u.first && c1 < u.keepHead)) { std::vector<std::string> text = TextBetween(lines, r1, c1, u.first, u.keepHead); JoinText(text, std::move(u.lines)); u.lines = std::move(text); u.first = r1; u.keepHead = c1; } if (r2 > er || (r2 == er && c2 > ec)) { JoinText(u.lines, TextBetween(lines, er, ec, r2, c2)); u.linesAfter = last - r2; u.keepTail = (int)lines[r2].size() - c2; } }
 Editor::Editor() { createNewFile(); }
-void Editor::init(Font f) { font = f; keywords = {"if", "else", "while", "for", "return", "using", "namespace", "class", "true", "false", "new", "delete", "include", "void", "int", "float", "double", "bool", "char", "string", "vector", "auto", "template", "typename", "const", "static", "public", "private", "std"}; types = {"Editor", "FileManager", "Terminal", "Theme", "Document", "vector", "string", "map", "uint8_t", "cout", "cin", "endl"}; updateFontMetrics(); }
+void Editor::init(Font f, const std::string& journalDir) { font = f; highlighter->init(); updateFontMetrics(); recoverJournals(journalDir); journal.start(journalDir); words.start(); }
+void Editor::cleanup() { commitEdits(); journal.stop(); words.stop(); symbols.close(); minimap.unload(); }
+void Editor::recoverJournals(const std::string& dir) { std::vector<std::string> kept; std::vector<RecoveredDoc> recovered = journal.recover(dir, kept); if (!kept.empty()) ShowToast(std::to_string(kept.size()) + " crash journal(s) no longer match their files: left in " + dir); if (recovered.empty()) return; Document& curr = currentDoc(); if (curr.path.empty() && curr.lines.size() == 1 && curr.lines[0].empty() && !curr.isDirty) { journal.close(curr.id); words.close(curr.id); docs.erase(docs.begin() + activeTab); } for (RecoveredDoc& r : recovered) { std::unique_ptr<Document> d = std::make_unique<Document>(r.path); d->lines = std::move(r.lines); journal.open(d->id, d->path, false); std::vector<std::string> saved; if (!d->path.empty() && ReadTextFile(d->path, saved, d->format)) d->diff.reset(saved); d->touch(0, 1, (int)d->lines.size()); docs.push_back(std::move(d)); } activeTab = (int)docs.size() - 1; commitEdits(); for (const RecoveredDoc& r : recovered) journal.retire(r.journal); ShowToast("Recovered " + std::to_string(recovered.size()) + " unsaved file(s)"); }
+void Editor::commitEdits() { for (std::unique_ptr<Document>& d : docs) { Document& doc = *d; if (doc.edits.first < 0) continue; if (doc.edits.fromCol >= 0) journal.appendBytes(doc.id, doc.edits.first, doc.edits.fromCol, doc.edits.keepTail, doc.lines[doc.edits.first]); else journal.append(doc.id, doc.edits.first, doc.edits.oldEnd - doc.edits.first, doc.lines, doc.edits.newEnd - doc.edits.first, doc.edits.pasted); doc.wrap.splice(doc.edits.first, doc.edits.oldEnd - doc.edits.first, doc.lines, doc.edits.newEnd - doc.edits.first); doc.brackets.splice(doc.edits.first, doc.edits.oldEnd - doc.edits.first, doc.lines, doc.edits.newEnd - doc.edits.first, doc.edits.pasted); doc.diff.splice(doc.edits.first, doc.edits.oldEnd - doc.edits.first, doc.lines, doc.edits.newEnd - doc.edits.first, doc.edits.pasted); words.splice(doc.id, doc.edits.first, doc.edits.oldEnd - doc.edits.first, doc.lines, doc.edits.newEnd - doc.edits.first, doc.edits.pasted); minimap.onEdit(doc.id, doc.edits.first, doc.edits.oldEnd - doc.edits.first, doc.edits.newEnd - doc.edits.first); doc.edits = EditRange(); } }
+bool Editor::refuseEdit(Document& doc) { if (!doc.following && !doc.partialView) return false; std::string msg = doc.following ? "Following " + doc.filename + ": read-only (Ctrl+L to stop)" : doc.filename + " only holds the end of the file: close and reopen it to edit"; if (toastQueue.empty() || toastQueue.back().message != msg) ShowToast(msg); return true; }
+// Lines a followed file gained or let go: the same bookkeeping as commitEdits, except they are already on disk, so nothing is journaled and the diff's baseline moves with them.
+void Editor::spliceFollowed(Document& doc, int first, int oldCount, int newCount, int firstCol) { doc.columns.splice(first, oldCount, newCount, firstCol); doc.version++; doc.bytesStale = true; doc.wrap.splice(first, oldCount, doc.lines, newCount); doc.brackets.splice(first, oldCount, doc.lines, newCount); doc.diff.rebase(first, oldCount, doc.lines, newCount); words.splice(doc.id, first, oldCount, doc.lines, newCount); minimap.onEdit(doc.id, first, oldCount, newCount); }
+void Editor::applyFollow(Document& doc, FollowChunk& chunk) { if (chunk.pieces.empty()) chunk.pieces.push_back(""); bool atBottom = doc.scroll + viewRows >= (doc.wrap.enabled ? doc.wrap.totalRows() : (int)doc.lines.size()); bool caretAtEnd = doc.row == (int)doc.lines.size() - 1 && !hasSelection(doc); bool terminated = chunk.pieces.size() > 1; bool ended = terminated && chunk.pieces.back().empty(); if (ended) chunk.pieces.pop_back(); if (chunk.reset) { int oldCount = (int)doc.lines.size(); doc.lines.swap(chunk.pieces); clearSelection(doc); doc.row = std::min(doc.row, (int)doc.lines.size() - 1); doc.col = 0; doc.partialView = chunk.skippedHead; spliceFollowed(doc, 0, oldCount, (int)doc.lines.size()); ShowToast(doc.filename + " was truncated or replaced: reloaded"); } else { bool open = !doc.format.finalNewline; int first = open ? (int)doc.lines.size() - 1 : (int)doc.lines.size(); int firstCol = open ? (int)doc.lines.back().size() : 0; if (open) doc.lines.back() += chunk.pieces[0]; else doc.lines.push_back(std::move(chunk.pieces[0])); for (size_t i = 1; i < chunk.pieces.size(); i++) doc.lines.push_back(std::move(chunk.pieces[i])); std::string& joined = doc.lines[first]; if (open && terminated && !joined.empty() && joined.back() == '\r') { joined.pop_back(); firstCol = std::max(0, firstCol - 1); } spliceFollowed(doc, first, open ? 1 : 0, (int)doc.lines.size() - first, firstCol); } doc.format.finalNewline = ended; int cap = std::max(1000, settings.followMaxLines); if ((int)doc.lines.size() > cap + cap / Follower::TRIM_SLACK) { int drop = (int)doc.lines.size() - cap; int dropRows = visualRow(doc, drop, 0); doc.lines.erase(doc.lines.begin(), doc.lines.begin() + drop); spliceFollowed(doc, 0, drop, 0); doc.scroll = std::max(0, doc.scroll - dropRows); if (doc.row < drop) { doc.row = 0; doc.col = 0; } else doc.row -= drop; clearSelection(doc); doc.partialView = true; } if (caretAtEnd) { doc.row = (int)doc.lines.size() - 1; doc.col = (int)doc.lines[doc.row].size(); } if (atBottom) doc.scroll = std::max(0, (doc.wrap.enabled ? doc.wrap.totalRows() : (int)doc.lines.size()) - viewRows); }
+void Editor::closeTab(int index) { follower.stop(docs[index]->id); journal.close(docs[index]->id); words.close(docs[index]->id); docs.erase(docs.begin() + index); if (activeTab >= (int)docs.size()) activeTab = (int)docs.size() - 1; if (docs.empty()) createNewFile(); }
 void Editor::reloadFont(Font f) { font = f; updateFontMetrics(); }
 void Editor::updateFontMetrics() { Vector2 m = MeasureTextEx(font, "M", (float)settings.fontSize, 1.0f); charWidth = m.x; lineHeight = (int)m.y; }
-Document& Editor::currentDoc() { if (docs.empty()) createNewFile(); if (activeTab >= (int)docs.size()) activeTab = (int)docs.size() - 1; return docs[activeTab]; }
+Document& Editor::currentDoc() { if (docs.empty()) createNewFile(); if (activeTab >= (int)docs.size()) activeTab = (int)docs.size() - 1; return *docs[activeTab]; }
 std::string Editor::getCurrentPath() { return currentDoc().path; }
-void Editor::pushUndo() { Document& doc = currentDoc(); if (doc.undoStack.size() > 50) doc.undoStack.pop_front(); doc.undoStack.push_back({doc.lines, doc.row, doc.col}); }
-void Editor::performUndo() { Document& doc = currentDoc(); if (!doc.undoStack.empty()) { UndoState state = doc.undoStack.back(); doc.undoStack.pop_back(); doc.lines = state.lines; doc.row = state.row; doc.col = state.col; doc.isDirty = true; } }
+void Editor::pushUndo() { Document& doc = currentDoc(); if (doc.undoStack.size() > 50) doc.undoStack.pop_front(); doc.undoStack.push_back({doc.row, doc.col}); }
+// Puts the step's span back as it was; the journal and indexes see just that span change.
+void Editor::performUndo() { Document& doc = currentDoc(); if (doc.undoStack.empty()) return; UndoState& u = doc.undoStack.back(); if (!u.lines.empty()) { int er = (int)doc.lines.size() - 1 - u.linesAfter; int ec = (int)doc.lines[er].size() - u.keepTail; int n = (int)u.lines.size(); if (u.first == er && n == 1) doc.lines[er].replace(u.keepHead, ec - u.keepHead, u.lines[0]); else { std::string tail = doc.lines[er].substr(ec); doc.lines[u.first].erase(u.keepHead); doc.lines[u.first] += u.lines[0]; doc.lines.erase(doc.lines.begin() + u.first + 1, doc.lines.begin() + er + 1); if (n == 1) doc.lines[u.first] += tail; else { u.lines.back() += tail; doc.lines.insert(doc.lines.begin() + u.first + 1, std::make_move_iterator(u.lines.begin() + 1), std::make_move_iterator(u.lines.end())); } } doc.touch(u.first, er - u.first + 1, n, u.keepHead, u.keepTail); } doc.row = u.row; doc.col = u.col; clearSelection(doc); doc.undoStack.pop_back(); }
 bool Editor::hasSelection(const Document& doc) { return doc.selRowStart != -1; }
 void Editor::clearSelection(Document& doc) { doc.selRowStart = -1; doc.selecting = false; }
 void Editor::normalizeSelection(int& r1, int& c1, int& r2, int& c2, const Document& doc) { r1 = doc.selRowStart; c1 = doc.selColStart; r2 = doc.selRowEnd; c2 = doc.selColEnd; if (r1 > r2 || (r1 == r2 && c1 > c2)) { std::swap(r1, r2); std::swap(c1, c2); } }
-std::string Editor::getSelectedText(const Document& doc) { if (!hasSelection(doc)) return ""; int r1, c1, r2, c2; normalizeSelection(r1, c1, r2, c2, doc); std::string result; for (int i = r1; i <= r2; i++) { std::string line = doc.lines[i]; int start = (i == r1) ? c1 : 0; int end = (i == r2) ? c2 : line.size(); if (start < line.size()) result += line.substr(start, end - start); if (i != r2) result += "\n"; } return result; }
-void Editor::deleteSelection(Document& doc) { if (!hasSelection(doc)) return; int r1, c1, r2, c2; normalizeSelection(r1, c1, r2, c2, doc); if (r1 == r2) doc.lines[r1].erase(c1, c2 - c1); else { std::string tail = doc.lines[r2].substr(c2); doc.lines[r1].erase(c1); doc.lines[r1] += tail; doc.lines.erase(doc.lines.begin() + r1 + 1, doc.lines.begin() + r2 + 1); } doc.row = r1; doc.col = c1; clearSelection(doc); doc.isDirty = true; }
+std::string Editor::getSelectedText(const Document& doc) { if (!hasSelection(doc)) return ""; int r1, c1, r2, c2; normalizeSelection(r1, c1, r2, c2, doc); auto span = [&](int i, size_t& start, size_t& end) { const std::string& line = doc.lines[i]; start = std::min((size_t)((i == r1) ? c1 : 0), line.size()); end = std::max(start, std::min((size_t)((i == r2) ? c2 : line.size()), line.size())); }; size_t total = r2 - r1, a, b; for (int i = r1; i <= r2; i++) { span(i, a, b); total += b - a; } std::string result(total, '\0'); char* out = &result[0]; for (int i = r1; i <= r2; i++) { span(i, a, b); memcpy(out, doc.lines[i].data() + a, b - a); out += b - a; if (i != r2) *out++ = '\n'; } return result; }
+void Editor::deleteSelection(Document& doc) { if (!hasSelection(doc)) return; int r1, c1, r2, c2; normalizeSelection(r1, c1, r2, c2, doc); doc.noteEdit(r1, c1, r2, c2); if (r1 == r2) doc.lines[r1].erase(c1, c2 - c1); else { std::string tail = doc.lines[r2].substr(c2); doc.lines[r1].erase(c1); doc.lines[r1] += tail; doc.lines.erase(doc.lines.begin() + r1 + 1, doc.lines.begin() + r2 + 1); } doc.row = r1; doc.col = c1; clearSelection(doc); doc.touch(r1, r2 - r1 + 1, 1, c1, (int)doc.lines[r1].size() - c1); }
 void Editor::selectAll() { Document& doc = currentDoc(); if (doc.lines.empty()) return; doc.selRowStart = 0; doc.selColStart = 0; doc.selRowEnd = doc.lines.size() - 1; doc.selColEnd = doc.lines.back().size(); doc.row = doc.selRowEnd; doc.col = doc.selColEnd; doc.selecting = true; }
-void Editor::copyToClipboard() { Document& doc = currentDoc(); std::string text = getSelectedText(doc); if (!text.empty()) { SetClipboardText(text.c_str()); ShowToast("Copied"); } }
-void Editor::pasteFromClipboard() { const char* text = GetClipboardText(); if (!text) return; std::string str(text); if (str.empty()) return; Document& doc = currentDoc(); pushUndo(); if (hasSelection(doc)) deleteSelection(doc); size_t pos = 0; while (pos < str.length()) { size_t next = str.find('\n', pos); std::string segment; if (next == std::string::npos) { segment = str.substr(pos); pos = str.length(); } else { segment = str.substr(pos, next - pos); if (!segment.empty() && segment.back() == '\r') segment.pop_back(); pos = next + 1; } doc.lines[doc.row].insert(doc.col, segment); doc.col += segment.length(); if (pos < str.length() || (next != std::string::npos)) { std::string rest = doc.lines[doc.row].substr(doc.col); doc.lines[doc.row] = doc.lines[doc.row].substr(0, doc.col); doc.lines.insert(doc.lines.begin() + doc.row + 1, rest); doc.row++; doc.col = 0; } } doc.isDirty = true; }
+void Editor::copyToClipboard() { Document& doc = currentDoc(); std::string text = getSelectedText(doc); if (!text.empty()) { Input::SetClipboardText(text.c_str()); ShowToast("Copied"); } }
+void Editor::pasteFromClipboard() { const char* text = Input::GetClipboardText(); if (!text || !*text) return; Document& doc = currentDoc(); pushUndo(); if (hasSelection(doc)) deleteSelection(doc); std::shared_ptr<PastedText> pasted = std::make_shared<PastedText>(); pasted->body = text; doc.insertText(std::move(pasted)); }
 void Editor::moveLeft(Document& doc, bool ctrl) { if (ctrl) { if (doc.col == 0) { if (doc.row > 0) { doc.row--; doc.col = doc.lines[doc.row].size(); } } else { std::string& line = doc.lines[doc.row]; while (doc.col > 0 && isspace(line[doc.col - 1])) doc.col--; if (doc.col > 0) { bool isWord = IsWordChar(line[doc.col - 1]); while (doc.col > 0) { if (isspace(line[doc.col - 1]) || IsWordChar(line[doc.col - 1]) != isWord) break; doc.col--; } } } } else { if (doc.col > 0) { doc.col--; while (doc.col > 0 && IsContinuationByte(doc.lines[doc.row][doc.col])) doc.col--; } else if (doc.row > 0) { doc.row--; doc.col = doc.lines[doc.row].size(); } } }
 void Editor::moveRight(Document& doc, bool ctrl) { int len = (int)doc.lines[doc.row].size(); if (ctrl) { if (doc.col >= len) { if (doc.row < (int)doc.lines.size() - 1) { doc.row++; doc.col = 0; } } else { std::string& line = doc.lines[doc.row]; bool isWord = IsWordChar(line[doc.col]); while (doc.col < len) { if (isspace(line[doc.col]) || IsWordChar(line[doc.col]) != isWord) break; doc.col++; } while (doc.col < len && isspace(line[doc.col])) doc.col++; } } else { if (doc.col < len) { doc.col++; while (doc.col < len && IsContinuationByte(doc.lines[doc.row][doc.col])) doc.col++; } else if (doc.row < (int)doc.lines.size() - 1) { doc.row++; doc.col = 0; } } }
-void Editor::deleteCharBackwards() { Document& doc = currentDoc(); if (doc.col > 0) { int originalCol = doc.col; moveLeft(doc); int bytesToDelete = originalCol - doc.col; doc.lines[doc.row].erase(doc.col, bytesToDelete); doc.isDirty = true; } else if (doc.row > 0) { doc.col = doc.lines[doc.row - 1].size(); doc.lines[doc.row - 1] += doc.lines[doc.row]; doc.lines.erase(doc.lines.begin() + doc.row); doc.row--; doc.isDirty = true; } }
-void Editor::deleteWordBackwards() { Document& doc = currentDoc(); if (doc.col == 0) { deleteCharBackwards(); return; } std::string& line = doc.lines[doc.row]; int start = doc.col; while (start > 0 && (line[start-1] == ' ' || line[start-1] == '\t')) start--; if (start > 0) { bool isAlpha = isalnum(line[start-1]) || line[start-1] == '_'; while (start > 0) { bool prev = isalnum(line[start-1]) || line[start-1] == '_'; if (prev != isAlpha) break; start--; } } line.erase(start, doc.col - start); doc.col = start; doc.isDirty = true; }
-void Editor::deleteCharForwards() { Document& doc = currentDoc(); if (doc.col >= (int)doc.lines[doc.row].size()) { if (doc.row < (int)doc.lines.size() - 1) { doc.lines[doc.row] += doc.lines[doc.row + 1]; doc.lines.erase(doc.lines.begin() + doc.row + 1); doc.isDirty = true; } } else { int bytes = 1; while (doc.col + bytes < (int)doc.lines[doc.row].size() && IsContinuationByte(doc.lines[doc.row][doc.col + bytes])) bytes++; doc.lines[doc.row].erase(doc.col, bytes); doc.isDirty = true; } }
-void Editor::deleteWordForwards() { Document& doc = currentDoc(); if (doc.col >= (int)doc.lines[doc.row].size()) { deleteCharForwards(); return; } std::string& line = doc.lines[doc.row]; int start = doc.col; int len = (int)line.size(); int end = start; bool isWord = IsWordChar(line[end]); while (end < len) { if (isspace(line[end]) || IsWordChar(line[end]) != isWord) break; end++; } while (end < len && isspace(line[end])) end++; line.erase(start, end - start); doc.isDirty = true; }
-void Editor::createNewFile() { docs.push_back(Document()); activeTab = (int)docs.size() - 1; }
-void Editor::loadFile(const std::string& path) { for (size_t i = 0; i < docs.size(); i++) { if (docs[i].path == path) { activeTab = i; return; } } std::ifstream in(path); if (in.is_open()) { Document newDoc(path); newDoc.lines.clear(); std::string line; while (std::getline(in, line)) { if (!line.empty() && line.back() == '\r') line.pop_back(); newDoc.lines.push_back(line); } if (newDoc.lines.empty()) newDoc.lines.push_back(""); Document& curr = currentDoc(); if (curr.path.empty() && curr.lines.size()==1 && curr.lines[0].empty() && !curr.isDirty) docs[activeTab] = newDoc; else { docs.push_back(newDoc); activeTab = (int)docs.size()-1; } } }
-void Editor::saveAs() { Document& doc = currentDoc(); std::string newPath = SaveWindowsFileDialog(doc.filename.c_str()); if (!newPath.empty()) { doc.path = newPath; size_t pos = doc.path.find_last_of("/\\"); doc.filename = (pos == std::string::npos) ? doc.path : doc.path.substr(pos + 1); saveFile(); } }
-void Editor::saveFile() { Document& doc = currentDoc(); if (doc.path.empty()) { saveAs(); return; } std::ofstream out(doc.path); if (out.is_open()) { for (size_t i = 0; i < doc.lines.size(); i++) { out << doc.lines[i]; if (i < doc.lines.size() - 1) out << "\n"; } doc.isDirty = false; ShowToast("Saved: " + doc.filename); } else ShowToast("Save Failed!"); }
-void Editor::update(Rectangle bounds, bool isFocused) { if (!isFocused) return; Document& doc = currentDoc(); bool ctrl = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL); bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT); float gutterWidth = 0.0f; if (settings.showLineNumbers) { int maxLines = (int)doc.lines.size(); int digits = (maxLines == 0) ? 1 : (int)log10(maxLines) + 1; gutterWidth = digits * charWidth + Config::GUTTER_PADDING; } if (ctrl) { if (IsKeyPressed(KEY_S)) saveFile(); if (IsKeyPressed(KEY_Z)) { performUndo(); return; } if (IsKeyPressed(KEY_N)) createNewFile(); if (IsKeyPressed(KEY_W)) { if (!docs.empty()) { docs.erase(docs.begin() + activeTab); if (activeTab >= (int)docs.size()) activeTab = (int)docs.size() - 1; if (docs.empty()) createNewFile(); } } if (IsKeyPressed(KEY_A)) selectAll(); if (IsKeyPressed(KEY_C)) copyToClipboard(); if (IsKeyPressed(KEY_V)) pasteFromClipboard(); float wheel = GetMouseWheelMove(); if (wheel != 0) { settings.fontSize += (int)wheel * 2; if (settings.fontSize < 10) settings.fontSize = 10; updateFontMetrics(); return; } } else { float wheel = GetMouseWheelMove(); doc.scroll -= (int)wheel * 3; if (doc.scroll < 0) doc.scroll = 0; } int c = GetCharPressed(); if (c > 0) { pushUndo(); deleteSelection(doc); } while (c > 0) { std::string utf8Str = CodepointToUTF8(c); doc.lines[doc.row].insert(doc.col, utf8Str); doc.col += utf8Str.length(); if (c=='{') doc.lines[doc.row].insert(doc.col, "}"); if (c=='(') doc.lines[doc.row].insert(doc.col, ")"); if (c=='[') doc.lines[doc.row].insert(doc.col, "]"); if (c=='"') doc.lines[doc.row].insert(doc.col, "\""); doc.isDirty = true; c = GetCharPressed(); } if ((ctrl && IsKeyPressed(KEY_BACKSPACE)) || (ctrl && IsKeyPressed(KEY_SPACE))) { pushUndo(); deleteSelection(doc); deleteWordBackwards(); } else if (IsKeyDown(KEY_BACKSPACE) && !ctrl) { if (IsKeyPressed(KEY_BACKSPACE)) { pushUndo(); if (hasSelection(doc)) deleteSelection(doc); else deleteCharBackwards(); backspaceTimer = 0.0f; } else { backspaceTimer += GetFrameTime(); if (backspaceTimer > backspaceDelay) { if (((int)((backspaceTimer - backspaceDelay)/backspaceSpeed)) > ((int)((backspaceTimer - backspaceDelay - GetFrameTime())/backspaceSpeed))) { if (hasSelection(doc)) deleteSelection(doc); else deleteCharBackwards(); } } } } else backspaceTimer = 0.0f; if (IsKeyPressed(KEY_DELETE)) { pushUndo(); if (hasSelection(doc)) deleteSelection(doc); else { if (ctrl) deleteWordForwards(); else deleteCharForwards(); } } if (IsKeyPressed(KEY_ENTER)) { pushUndo(); deleteSelection(doc); std::string cur = doc.lines[doc.row]; std::string rest = cur.substr(doc.col); doc.lines[doc.row] = cur.substr(0, doc.col); int indent = 0; while(indent < (int)doc.lines[doc.row].size() && doc.lines[doc.row][indent] == ' ') indent++; if (doc.col > 0 && doc.lines[doc.row][doc.col-1] == '{') { if (!rest.empty() && rest[0] == '}') { doc.lines.insert(doc.lines.begin() + doc.row + 1, std::string(indent, ' ') + rest); doc.lines.insert(doc.lines.begin() + doc.row + 1, std::string(indent + 4, ' ')); doc.row++; doc.col = indent + 4; } else { indent += 4; doc.lines.insert(doc.lines.begin() + doc.row + 1, std::string(indent, ' ') + rest); doc.row++; doc.col = indent; } } else { doc.lines.insert(doc.lines.begin() + doc.row + 1, std::string(indent, ' ') + rest); doc.row++; doc.col = indent; } doc.isDirty = true; } if (IsKeyPressed(KEY_TAB) && !ctrl) { pushUndo(); deleteSelection(doc); doc.lines[doc.row].insert(doc.col, std::string(settings.tabSize, ' ')); doc.col += settings.tabSize; doc.isDirty = true; } bool moved = false; if (IsKeyPressed(KEY_LEFT) || IsKeyPressed(KEY_RIGHT) || IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_DOWN)) moved = true; if (moved) { if (shift && !doc.selecting) { doc.selecting = true; doc.selRowStart = doc.row; doc.selColStart = doc.col; } if (!shift && !doc.selecting) clearSelection(doc); } if (IsKeyPressed(KEY_LEFT)) moveLeft(doc, ctrl); if (IsKeyPressed(KEY_RIGHT)) moveRight(doc, ctrl); if (IsKeyPressed(KEY_UP)) { if (doc.row > 0) doc.row--; if (doc.col > (int)doc.lines[doc.row].size()) doc.col = doc.lines[doc.row].size(); } if (IsKeyPressed(KEY_DOWN)) { if (doc.row < (int)doc.lines.size() - 1) doc.row++; if (doc.col > (int)doc.lines[doc.row].size()) doc.col = doc.lines[doc.row].size(); } if (shift && doc.selecting) { doc.selRowEnd = doc.row; doc.selColEnd = doc.col; } if (!shift && doc.selecting && moved) clearSelection(doc); Vector2 m = GetMousePosition(); float tabX = bounds.x; float tabH = Config::TAB_HEIGHT; for (int i=0; i<docs.size(); i++) { std::string t = docs[i].filename + (docs[i].isDirty?"*":""); float tW = MeasureTextEx(font, t.c_str(), Config::FONT_SIZE_UI, 1).x + 40; Rectangle tabR = {tabX, bounds.y, tW, tabH}; if (CheckCollisionPointRec(m, tabR)) { Rectangle closeR = {tabX + tW - 25, bounds.y + 5, 20, 20}; if (CheckCollisionPointRec(m, closeR)) { if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { docs.erase(docs.begin() + i); if (activeTab >= (int)docs.size()) activeTab = (int)docs.size()-1; if (docs.empty()) createNewFile(); return; } } else if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) activeTab = i; } tabX += tW + 2; } Rectangle contentR = {bounds.x, bounds.y + tabH, bounds.width, bounds.height - tabH}; if (CheckCollisionPointRec(m, contentR)) { float relY = m.y - contentR.y; float relX = m.x - contentR.x - gutterWidth; int r = (int)(relY / lineHeight) + doc.scroll; r = Clamp(r, 0, (int)doc.lines.size() - 1); int c = (int)round(relX / charWidth); c = Clamp(c, 0, (int)doc.lines[r].size()); if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { doc.row = r; doc.col = c; doc.selecting = true; doc.selRowStart = r; doc.selColStart = c; doc.selRowEnd = r; doc.selColEnd = c; } else if (IsMouseButtonDown(MOUSE_LEFT_BUTTON) && doc.selecting) { doc.selRowEnd = r; doc.selColEnd = c; doc.row = r; doc.col = c; } else if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) { if (doc.selRowStart == doc.selRowEnd && doc.selColStart == doc.selColEnd) clearSelection(doc); } } blink += GetFrameTime(); if (blink > 0.5f) { blink = 0; showCursor = !showCursor; } }
-void Editor::render(Rectangle bounds) { float tabH = Config::TAB_HEIGHT; Vector2 mouse = GetMousePosition(); float tabX = bounds.x; for (int i=0; i<docs.size(); i++) { std::string title = docs[i].filename + (docs[i].isDirty ? "*" : ""); float textW = MeasureTextEx(font, title.c_str(), Config::FONT_SIZE_UI, 1).x; float tabW = textW + 40; Rectangle tabRect = {tabX, bounds.y, tabW, tabH}; bool isHover = CheckCollisionPointRec(mouse, tabRect); DrawRectangleRec(tabRect, (i==activeTab) ? theme.tabActive : theme.tabInactive); if (i==activeTab) DrawRectangle((int)tabX, (int)bounds.y, (int)tabW, 2, theme.keyword); Color titleColor = (i==activeTab) ? theme.tabTextActive : GRAY; DrawTextEx(font, title.c_str(), {tabX+10, bounds.y+5}, Config::FONT_SIZE_UI, 1, titleColor); if (isHover) DrawTextEx(font, "x", {tabX + tabW - 20, bounds.y + 5}, 18, 1, theme.closeBtn); DrawLine((int)(tabX+tabW), (int)bounds.y, (int)(tabX+tabW), (int)(bounds.y+tabH), theme.border); tabX += tabW + 2; } DrawRectangle((int)tabX, (int)bounds.y, (int)(bounds.width-(tabX-bounds.x)), (int)tabH, theme.panelBg); Rectangle content = {bounds.x, bounds.y+tabH, bounds.width, bounds.height-tabH}; Document& doc = currentDoc(); DrawRectangleRec(content, theme.bg); BeginScissorMode((int)content.x, (int)content.y, (int)content.width, (int)content.height); float gutterWidth = 0.0f; if (settings.showLineNumbers) { int maxLines = (int)doc.lines.size(); int digits = (maxLines == 0) ? 1 : (int)log10(maxLines) + 1; gutterWidth = digits * charWidth + Config::GUTTER_PADDING; DrawRectangleRec({content.x, content.y, gutterWidth, content.height}, theme.gutterBg); DrawLine(content.x + gutterWidth, content.y, content.x + gutterWidth, content.y + content.height, theme.border); } int vis = (int)(content.height / lineHeight) + 1; for (int i=0; i<vis; i++) { int idx = i + doc.scroll; if (idx >= doc.lines.size()) break; int yPos = (int)(content.y + i*lineHeight); if (settings.showLineNumbers) { std::string num = std::to_string(idx + 1); float tw = MeasureTextEx(font, num.c_str(), settings.fontSize, 1.0f).x; DrawTextEx(font, num.c_str(), {content.x + gutterWidth - tw - 10, (float)yPos}, settings.fontSize, 1.0f, theme.lineNumber); } drawLine(doc, idx, (int)(content.x + gutterWidth + 5), yPos); } if (showCursor) { std::string sub = doc.lines[doc.row].substr(0, doc.col); float cursorX = MeasureTextEx(font, sub.c_str(), settings.fontSize, 1.0f).x; int cx = (int)(content.x + gutterWidth + 5 + cursorX); int cy = (int)(content.y + (doc.row - doc.scroll) * lineHeight); if (cy >= content.y && cy < content.y + content.height) DrawRectangle(cx, cy, 2, lineHeight, theme.cursor); } EndScissorMode(); }
-void Editor::drawLine(const Document& doc, int lineIdx, int x, int y) { std::string text = doc.lines[lineIdx]; float cx = (float)x; if (hasSelection(doc)) { int r1, c1, r2, c2; normalizeSelection(r1, c1, r2, c2, doc); if (lineIdx >= r1 && lineIdx <= r2) { float startX = 0, width = 0; if (lineIdx == r1) startX = MeasureTextEx(font, text.substr(0, c1).c_str(), settings.fontSize, 1.0f).x; if (lineIdx == r2) width = MeasureTextEx(font, text.substr(0, c2).c_str(), settings.fontSize, 1.0f).x - startX; else width = MeasureTextEx(font, text.c_str(), settings.fontSize, 1.0f).x - startX + 10; if (lineIdx > r1 && lineIdx < r2) { startX = 0; width = MeasureTextEx(font, text.c_str(), settings.fontSize, 1.0f).x + 10; } DrawRectangle((int)(cx + startX), y, (int)width, lineHeight, theme.selection); } } size_t pos = 0; while (pos < text.length()) { size_t nextSpace = text.find_first_of(" \t", pos); if (nextSpace == std::string::npos) nextSpace = text.length(); std::string word = text.substr(pos, nextSpace - pos); Color c = theme.text; if (keywords.count(word)) c = theme.keyword; else if (types.count(word)) c = theme.type; else if (isdigit(word[0])) c = theme.number; else if (word.find("//") == 0) c = theme.comment; else if (word.find("\"") != std::string::npos) c = theme.string; DrawTextEx(font, word.c_str(), {cx, (float)y}, (float)settings.fontSize, 1.0f, c); cx += MeasureTextEx(font, word.c_str(), settings.fontSize, 1.0f).x; if (word.length() > 0 && nextSpace < text.length()) cx += 1.0f; if (nextSpace < text.length()) { char delim = text[nextSpace]; std::string dStr(1, delim); DrawTextEx(font, dStr.c_str(), {cx, (float)y}, (float)settings.fontSize, 1.0f, theme.text); cx += MeasureTextEx(font, dStr.c_str(), settings.fontSize, 1.0f).x; if (nextSpace + 1 < text.length()) cx += 1.0f; pos = nextSpace + 1; } else pos = nextSpace; } }
\ No newline at end of file
+void Editor::moveVertical(Document& doc, int dir) { if (doc.wrap.enabled) { int vr = visualRow(doc, doc.row, doc.col); const std::string& text = doc.lines[doc.row]; int vc = doc.columns.column(text, doc.row, doc.col) - doc.wrap.rowStart(text, doc.row, vr - doc.wrap.rowOfLine(doc.row)); int target = Clamp(vr + dir, 0, doc.wrap.totalRows() - 1); if (target == vr) return; hitTest(doc, target, vc, doc.row, doc.col); return; } doc.row = Clamp(doc.row + dir, 0, (int)doc.lines.size() - 1); if (doc.col > (int)doc.lines[doc.row].size()) doc.col = doc.lines[doc.row].size(); }
+float Editor::gutterWidthFor(const Document& doc) { if (!settings.showLineNumbers) return 0.0f; int maxLines = (int)doc.lines.size(); int digits = (maxLines == 0) ? 1 : (int)log10(maxLines) + 1; return digits * charWidth + Config::GUTTER_PADDING; }
+void Editor::syncWrap(Document& doc, float textWidth) { int w = std::max(1, (int)(textWidth / charWidth)); if (!settings.wordWrap) { if (doc.wrap.enabled) { int line, sub; doc.wrap.find(doc.scroll, line, sub); doc.scroll = line; doc.wrap.enabled = false; doc.wrap.clear(); } return; } if (!doc.wrap.enabled) { doc.wrap.reset(doc.lines, w); doc.wrap.enabled = true; doc.scroll = doc.wrap.rowOfLine(doc.scroll); } doc.wrap.requestWidth(doc.lines, w); doc.wrap.poll(doc.lines); }
+int Editor::visualRow(const Document& doc, int row, int col, size_t* segStart) { if (segStart) *segStart = 0; if (!doc.wrap.enabled) { if (segStart) *segStart = doc.columns.offset(doc.lines[row], row, doc.scrollCol); return row; } const std::string& text = doc.lines[row]; int sub = doc.wrap.subRowOf(text, row, doc.columns.column(text, row, col)); if (segStart) *segStart = doc.columns.offset(text, row, doc.wrap.rowStart(text, row, sub)); return doc.wrap.rowOfLine(row) + sub; }
+void Editor::hitTest(const Document& doc, int vrow, int vcol, int& row, int& col) { if (!doc.wrap.enabled) { row = Clamp(vrow, 0, (int)doc.lines.size() - 1); col = (int)doc.columns.offset(doc.lines[row], row, doc.scrollCol + std::max(0, vcol)); return; } int sub; doc.wrap.find(vrow, row, sub); row = Clamp(row, 0, (int)doc.lines.size() - 1); const std::string& text = doc.lines[row]; int start = doc.wrap.rowStart(text, row, sub), end = doc.wrap.rowEnd(text, row, sub); int maxCol = std::max(0, (sub < doc.wrap.rowsOf(row) - 1) ? end - start - 1 : end - start); col = (int)doc.columns.offset(text, row, start + Clamp(vcol, 0, maxCol)); }
+bool Editor::caretPos(const Document& doc, int row, int col, int& vr, float& x) { size_t segStart = 0; vr = visualRow(doc, row, col, &segStart); if (col < (int)segStart || (!doc.wrap.enabled && col > (int)doc.columns.offset(doc.lines[row], row, doc.scrollCol + viewCols + 1))) return false; x = MeasureTextEx(font, frameArena.str(std::string_view(doc.lines[row]).substr(segStart, col - segStart)), settings.fontSize, 1.0f).x; return true; }
+void Editor::revealColumn(Document& doc) { if (doc.wrap.enabled) { doc.scrollCol = 0; return; } int c = doc.columns.column(doc.lines[doc.row], doc.row, doc.col); int margin = std::min(8, viewCols / 4); if (c < doc.scrollCol) doc.scrollCol = std::max(0, c - margin); else if (c >= doc.scrollCol + viewCols) doc.scrollCol = c - viewCols + 1 + margin; }
+void Editor::syncBrackets(Document& doc) { commitEdits(); if (!doc.brackets.isBuilt()) doc.brackets.reset(doc.lines); else doc.brackets.poll(doc.lines, true); }
+int Editor::bracketAtCursor(const Document& doc) { const std::string& line = doc.lines[doc.row]; if (doc.col < (int)line.size() && BracketIndex::isBracket(line[doc.col])) return doc.col; if (doc.col > 0 && doc.col <= (int)line.size() && BracketIndex::isBracket(line[doc.col - 1])) return doc.col - 1; return -1; }
+void Editor::jumpToBracket(Document& doc) { syncBrackets(doc); int r, c, at = bracketAtCursor(doc); bool found = (at >= 0) ? doc.brackets.match(doc.lines, doc.row, at, r, c) : doc.brackets.enclosing(doc.lines, doc.row, doc.col, r, c); if (!found) return; clearSelection(doc); doc.row = r; doc.col = c; int vr = visualRow(doc, r, c); if (vr < doc.scroll || vr >= doc.scroll + viewRows) doc.scroll = std::max(0, vr - viewRows / 2); }
+int Editor::indentOf(const std::string& line) { int n = 0; while (n < (int)line.size() && line[n] == ' ') n++; return n; }
+void Editor::updateCompletion(Document& doc) { const std::string& line = doc.lines[doc.row]; int start = doc.col; while (start > 0 && IsWordChar(line[start - 1])) start--; completionDoc = -1; if (doc.col - start < 2 || isdigit((unsigned char)line[start])) return; words.complete(line.substr(start, doc.col - start), completions, 8); completionSel = 0; if (!completions.empty()) completionDoc = doc.id; }
+void Editor::acceptCompletion(Document& doc) { std::string& line = doc.lines[doc.row]; int start = doc.col; while (start > 0 && IsWordChar(line[start - 1])) start--; pushUndo(); doc.noteEdit(doc.row, start, doc.row, doc.col); const std::string& word = completions[completionSel]; line.replace(start, doc.col - start, word); doc.col = start + (int)word.size(); doc.touch(doc.row, 1, 1, start, (int)line.size() - doc.col); completionDoc = -1; }
+void Editor::indexFolder(const std::string& path) { words.addFolder(path); symbols.open(path); }
+std::string Editor::wordAt(const Document& doc, int row, int col) { const std::string& line = doc.lines[row]; int s = Clamp(col, 0, (int)line.size()), e = s; while (s > 0 && IsWordChar(line[s - 1])) s--; while (e < (int)line.size() && IsWordChar(line[e])) e++; return line.substr(s, e - s); }
+void Editor::gotoDefinition(const std::string& name) { if (name.empty()) return; std::vector<SymbolHit> hits; symbols.find(name, hits); if (hits.empty()) { ShowToast(symbols.isReady() ? "No definition for " + name : "Symbol index not ready (open a folder)"); return; } lookupIndex = (name == lastLookup) ? (lookupIndex + 1) % (int)hits.size() : 0; lastLookup = name; const SymbolHit& hit = hits[lookupIndex]; bool open = false; for (int i = 0; i < (int)docs.size(); i++) if (!docs[i]->path.empty() && SymbolIndex::normalize(docs[i]->path) == hit.path) { activeTab = i; open = true; break; } if (!open) loadFile(hit.path); jumpDoc = currentDoc().id; jumpLine = hit.line - 1; if (hits.size() > 1) ShowToast(name + ": definition " + std::to_string(lookupIndex + 1) + "/" + std::to_string(hits.size())); }
+void Editor::openOutline() { Document& doc = currentDoc(); symbols.outline(doc.path, outlineItems); if (outlineItems.empty()) { ShowToast(doc.path.empty() || !symbols.isReady() ? "No outline (file is not in the indexed folder)" : "No symbols in " + doc.filename); return; } outlineOpen = true; outlineSel = 0; for (int i = 0; i < (int)outlineItems.size(); i++) if (outlineItems[i].line - 1 <= doc.row) outlineSel = i; }
+void Editor::gotoLine(int line) { Document& doc = currentDoc(); doc.row = Clamp(line, 0, (int)doc.lines.size() - 1); doc.col = 0; doc.scrollCol = 0; clearSelection(doc); doc.scroll = std::max(0, visualRow(doc, doc.row, 0) - viewRows / 2); }
+void Editor::toggleFollow() { Document& doc = currentDoc(); if (!doc.isResident()) return; if (doc.following) { follower.stop(doc.id); doc.following = false; journal.saved(doc.id, doc.path, doc.diff.savedLines(), doc.diff.savedHash()); ShowToast("Stopped following " + doc.filename); return; } if (doc.path.empty() || doc.isDirty) { ShowToast(doc.path.empty() ? "Save the file before following it" : "Save or undo the changes to " + doc.filename + " before following it"); return; } if (doc.format.encoding == TextEncoding::Utf16LE || doc.format.encoding == TextEncoding::Utf16BE) { ShowToast("UTF-16 files can't be followed"); return; } follower.start(doc); doc.following = true; doc.undoStack.clear(); doc.bytesStale = true; clearSelection(doc); doc.row = (int)doc.lines.size() - 1; doc.col = (int)doc.lines[doc.row].size(); doc.scroll = std::max(0, (doc.wrap.enabled ? doc.wrap.totalRows() : (int)doc.lines.size()) - viewRows); ShowToast("Following " + doc.filename + " (Ctrl+L to stop)"); }
+void Editor::deleteCharBackwards() { Document& doc = currentDoc(); if (doc.col > 0) { int originalCol = doc.col; moveLeft(doc); int bytesToDelete = originalCol - doc.col; doc.noteEdit(doc.row, doc.col, doc.row, originalCol); doc.lines[doc.row].erase(doc.col, bytesToDelete); doc.touch(doc.row, 1, 1, doc.col, (int)doc.lines[doc.row].size() - doc.col); } else if (doc.row > 0) { doc.noteEdit(doc.row - 1, (int)doc.lines[doc.row - 1].size(), doc.row, 0); doc.col = doc.lines[doc.row - 1].size(); doc.lines[doc.row - 1] += doc.lines[doc.row]; doc.lines.erase(doc.lines.begin() + doc.row); doc.row--; doc.touch(doc.row, 2, 1, doc.col); } }
+void Editor::deleteWordBackwards() { Document& doc = currentDoc(); if (doc.col == 0) { deleteCharBackwards(); return; } std::string& line = doc.lines[doc.row]; int start = doc.col; while (start > 0 && (line[start-1] == ' ' || line[start-1] == '\t')) start--; if (start > 0) { bool isAlpha = isalnum(line[start-1]) || line[start-1] == '_'; while (start > 0) { bool prev = isalnum(line[start-1]) || line[start-1] == '_'; if (prev != isAlpha) break; start--; } } doc.noteEdit(doc.row, start, doc.row, doc.col); line.erase(start, doc.col - start); doc.col = start; doc.touch(doc.row, 1, 1, start, (int)line.size() - start); }
+void Editor::deleteCharForwards() { Document& doc = currentDoc(); if (doc.col >= (int)doc.lines[doc.row].size()) { if (doc.row < (int)doc.lines.size() - 1) { doc.noteEdit(doc.row, doc.col, doc.row + 1, 0); doc.lines[doc.row] += doc.lines[doc.row + 1]; doc.lines.erase(doc.lines.begin() + doc.row + 1); doc.touch(doc.row, 2, 1, doc.col); } } else { int bytes = 1; while (doc.col + bytes < (int)doc.lines[doc.row].size() && IsContinuationByte(doc.lines[doc.row][doc.col + bytes])) bytes++; doc.noteEdit(doc.row, doc.col, doc.row, doc.col + bytes); doc.lines[doc.row].erase(doc.col, bytes); doc.touch(doc.row, 1, 1, doc.col, (int)doc.lines[doc.row].size() - doc.col); } }
+void Editor::deleteWordForwards() { Document& doc = currentDoc(); if (doc.col >= (int)doc.lines[doc.row].size()) { deleteCharForwards(); return; } std::string& line = doc.lines[doc.row]; int start = doc.col; int len = (int)line.size(); int end = start; bool isWord = IsWordChar(line[end]); while (end < len) { if (isspace(line[end]) || IsWordChar(line[end]) != isWord) break; end++; } while (end < len && isspace(line[end])) end++; doc.noteEdit(doc.row, start, doc.row, end); line.erase(start, end - start); doc.touch(doc.row, 1, 1, start, (int)line.size() - start); }
+void Editor::createNewFile() { docs.push_back(std::make_unique<Document>()); journal.open(docs.back()->id, "", false); activeTab = (int)docs.size() - 1; }
+void Editor::loadFile(const std::string& path) { for (size_t i = 0; i < docs.size(); i++) { if (docs[i]->path == path) { activeTab = i; return; } } std::unique_ptr<Document> newDoc = std::make_unique<Document>(path); if (ReadTextFile(path, newDoc->lines, newDoc->format)) { newDoc->diff.reset(newDoc->lines); if (newDoc->format.encoding != TextEncoding::Utf8) ShowToast("Opened as " + std::string(EncodingName(newDoc->format.encoding))); journal.open(newDoc->id, path, true, newDoc->diff.savedLines(), newDoc->diff.savedHash()); words.load(newDoc->id, path); Document& curr = currentDoc(); if (curr.isResident() && curr.path.empty() && curr.lines.size()==1 && curr.lines[0].empty() && !curr.isDirty) { journal.close(curr.id); words.close(curr.id); docs[activeTab] = std::move(newDoc); } else { docs.push_back(std::move(newDoc)); activeTab = (int)docs.size()-1; } } }
+void Editor::saveAs() { Document& doc = currentDoc(); if (!doc.isResident() || refuseEdit(doc)) return; std::string newPath = SaveWindowsFileDialog(doc.filename.c_str()); if (!newPath.empty()) { doc.path = newPath; size_t pos = doc.path.find_last_of("/\\"); doc.filename = (pos == std::string::npos) ? doc.path : doc.path.substr(pos + 1); saveFile(); } }
+void Editor::saveFile() { Document& doc = currentDoc(); if (!doc.isResident() || refuseEdit(doc)) return; if (doc.path.empty()) { saveAs(); return; } TextEncoding wanted = doc.format.encoding; if (WriteTextFile(doc.path, doc.lines, doc.format)) { commitEdits(); doc.isDirty = false; doc.diff.reset(doc.lines); journal.saved(doc.id, doc.path, doc.diff.savedLines(), doc.diff.savedHash()); symbols.fileChanged(doc.path); ShowToast(doc.format.encoding == wanted ? "Saved: " + doc.filename : "Saved as UTF-8: text has characters " + std::string(EncodingName(wanted)) + " can't store"); } else ShowToast("Save Failed!"); }
+void Editor::update(Rectangle bounds, bool isFocused) { Document& doc = currentDoc(); hibernator.update(docs, activeTab, Input::GetFrameTime(), [this](Document& d) { journal.saved(d.id, d.path, d.diff.savedLines(), d.diff.savedHash()); }); symbols.update(Input::GetFrameTime()); if (jumpDoc == doc.id && doc.isResident()) { gotoLine(jumpLine); jumpDoc = -1; } float mapW = settings.showMinimap ? Minimap::WIDTH : 0; if (doc.isResident()) syncWrap(doc, bounds.width - gutterWidthFor(doc) - 10 - mapW); viewRows = std::max(1, (int)((bounds.height - Config::TAB_HEIGHT) / lineHeight)); viewCols = std::max(1, (int)((bounds.width - gutterWidthFor(doc) - 10 - mapW) / charWidth)); handleInput(bounds, isFocused); commitEdits(); follower.update(Input::GetFrameTime(), [this](int id, FollowChunk& chunk) { for (std::unique_ptr<Document>& d : docs) if (d->id == id && d->isResident()) { applyFollow(*d, chunk); return; } }); for (std::unique_ptr<Document>& d : docs) { if (d->diff.poll()) d->isDirty = !d->diff.isClean(); if (d->isResident()) d->brackets.poll(d->lines); } Document& active = currentDoc(); if (!active.isResident()) { matchRow = -1; braceDoc = -1; return; } if (!active.brackets.isBuilt()) active.brackets.reset(active.lines); int at = bracketAtCursor(active); if (active.id != braceDoc || active.version != braceVersion || active.row != braceRow || at != braceCol) { braceDoc = active.id; braceVersion = active.version; braceCol = at; braceRow = active.row; if (braceCol < 0 || !active.brackets.match(active.lines, active.row, braceCol, matchRow, matchCol)) matchRow = -1; } if (settings.showMinimap) minimap.update(active.id, active.lines, (int)(bounds.height - Config::TAB_HEIGHT), highlighter); }
+bool Editor::handleTabBar(Rectangle bounds, Vector2 m) { float tabX = bounds.x; float tabH = Config::TAB_HEIGHT; for (int i=0; i<docs.size(); i++) { const char* t = frameArena.format("%s%s", docs[i]->filename.c_str(), docs[i]->isDirty ? "*" : docs[i]->following ? " (tail)" : ""); float tW = MeasureTextEx(font, t, Config::FONT_SIZE_UI, 1).x + 40; Rectangle tabR = {tabX, bounds.y, tW, tabH}; if (CheckCollisionPointRec(m, tabR)) { Rectangle closeR = {tabX + tW - 25, bounds.y + 5, 20, 20}; if (CheckCollisionPointRec(m, closeR)) { closeTab(i); return true; } activeTab = i; return false; } tabX += tW + 2; } return false; }
+void Editor::handleInput(Rectangle bounds, bool isFocused) { if (!isFocused) { input.clear(); return; } input.collect(); const std::vector<InputEvent>& events = input.pending(); bool clicked = false; Document& before = currentDoc(); int cursorDoc = before.id, cursorRow = before.row, cursorCol = before.col; for (size_t i = 0; i < events.size(); i++) { const InputEvent& ev = events[i]; Document& doc = currentDoc(); if (!doc.isResident()) { if (ev.type == InputEvent::Key && ev.ctrl && ev.code == KEY_W) closeTab(activeTab); else if (ev.type == InputEvent::MouseDown) handleTabBar(bounds, ev.pos); continue; } if (ev.type == InputEvent::Char) { size_t end = i + 1; while (end < events.size() && events[end].type == InputEvent::Char) end++; typeChars(doc, events, i, end); i = end - 1; } else if (ev.type == InputEvent::Key) handleKey(doc, ev); else if (ev.type == InputEvent::Wheel) { if (ev.ctrl) { settings.fontSize = std::max(10, settings.fontSize + (int)ev.wheel * 2); updateFontMetrics(); } else if (ev.shift && !doc.wrap.enabled) doc.scrollCol = std::max(0, doc.scrollCol - (int)ev.wheel * 8); else doc.scroll = std::max(0, doc.scroll - (int)ev.wheel * 3); } else { clicked |= ev.type == InputEvent::MouseDown; handlePointer(doc, bounds, ev); } } Document& doc = currentDoc(); if (doc.isResident() && !clicked) dragPointer(doc, bounds); if (doc.isResident() && doc.id == cursorDoc && (doc.row != cursorRow || doc.col != cursorCol)) revealColumn(doc); blink += Input::GetFrameTime(); if (blink > 0.5f) { blink = 0; showCursor = !showCursor; } }
+void Editor::typeChars(Document& doc, const std::vector<InputEvent>& events, size_t from, size_t to) { if (gotoOpen) { for (size_t k = from; k < to; k++) { int c = events[k].code; if (c >= '0' && c <= '9' && gotoInput.size() < 9) gotoInput += (char)c; } return; } if (outlineOpen || refuseEdit(doc)) return; pushUndo(); deleteSelection(doc); if (closerDoc != doc.id || closerRow != doc.row || closerAt != doc.col) closers.clear(); for (size_t k = from; k < to; k++) { int c = events[k].code; std::string& line = doc.lines[doc.row]; if (!closers.empty() && closers.back().first == doc.col && closers.back().second == c && doc.col < (int)line.size() && line[doc.col] == c) { doc.col++; closers.pop_back(); continue; } int at = doc.col, kept = (int)line.size() - at; doc.noteEdit(doc.row, at, doc.row, at); std::string utf8Str = CodepointToUTF8(c); line.insert(doc.col, utf8Str); for (auto& p : closers) if (p.first >= doc.col) p.first += (int)utf8Str.length(); doc.col += utf8Str.length(); char closer = (c=='{') ? '}' : (c=='(') ? ')' : (c=='[') ? ']' : (c=='"') ? '"' : 0; if (closer && (doc.col >= (int)line.size() || !IsWordChar(line[doc.col]))) { doc.noteEdit(doc.row, doc.col, doc.row, doc.col); line.insert(doc.col, 1, closer); for (auto& p : closers) if (p.first >= doc.col) p.first++; closers.push_back({doc.col, closer}); } doc.touch(doc.row, 1, 1, at, kept); } closerDoc = doc.id; closerRow = doc.row; closerAt = doc.col; updateCompletion(doc); }
+void Editor::handleKey(Document& doc, const InputEvent& ev) { int key = ev.code; bool ctrl = ev.ctrl, shift = ev.shift; if (key == KEY_F3) { latencyOverlay = !latencyOverlay; return; } if (ctrl && key == KEY_G) { gotoOpen = true; gotoInput.clear(); return; } if (gotoOpen) { if (key == KEY_BACKSPACE && !gotoInput.empty()) gotoInput.pop_back(); else if (key == KEY_ENTER) { if (!gotoInput.empty()) gotoLine(std::stoi(gotoInput) - 1); gotoOpen = false; } else if (key == KEY_ESCAPE) gotoOpen = false; return; } if (ctrl && key == KEY_R) { if (outlineOpen) outlineOpen = false; else openOutline(); return; } if (outlineOpen) { int n = (int)outlineItems.size(); if (key == KEY_DOWN) outlineSel = (outlineSel + 1) % n; else if (key == KEY_UP) outlineSel = (outlineSel + n - 1) % n; else if (key == KEY_ENTER) { gotoLine(outlineItems[outlineSel].line - 1); outlineOpen = false; } else if (key == KEY_ESCAPE) outlineOpen = false; return; } if (key == KEY_F12) { gotoDefinition(wordAt(doc, doc.row, doc.col)); return; } if (ctrl) { switch (key) { case KEY_S: saveFile(); return; case KEY_Z: if (!refuseEdit(doc)) performUndo(); return; case KEY_L: toggleFollow(); return; case KEY_N: createNewFile(); return; case KEY_W: if (!docs.empty()) closeTab(activeTab); return; case KEY_A: selectAll(); return; case KEY_C: copyToClipboard(); return; case KEY_V: if (!refuseEdit(doc)) pasteFromClipboard(); return; case KEY_M: jumpToBracket(doc); return; } } if (completionDoc == doc.id) { if (key == KEY_ESCAPE) completionDoc = -1; else if (key == KEY_DOWN) { completionSel = (completionSel + 1) % (int)completions.size(); return; } else if (key == KEY_UP) { completionSel = (completionSel + (int)completions.size() - 1) % (int)completions.size(); return; } else if (key == KEY_TAB || key == KEY_ENTER) { acceptCompletion(doc); return; } } if ((key == KEY_BACKSPACE || key == KEY_DELETE || key == KEY_ENTER || (key == KEY_TAB && !ctrl) || (ctrl && key == KEY_SPACE)) && refuseEdit(doc)) return; if (ctrl && (key == KEY_BACKSPACE || key == KEY_SPACE)) { if (!ev.repeat) pushUndo(); deleteSelection(doc); deleteWordBackwards(); completionDoc = -1; return; } if (key == KEY_BACKSPACE) { if (!ev.repeat) pushUndo(); if (hasSelection(doc)) deleteSelection(doc); else deleteCharBackwards(); completionDoc = -1; return; } if (key == KEY_DELETE) { if (!ev.repeat) pushUndo(); if (hasSelection(doc)) deleteSelection(doc); else if (ctrl) deleteWordForwards(); else deleteCharForwards(); completionDoc = -1; return; } if (key == KEY_ENTER) { if (!ev.repeat) pushUndo(); deleteSelection(doc); syncBrackets(doc); int startRow = doc.row; int before = (int)doc.lines.size(); int orow, ocol; bool nested = doc.brackets.enclosing(doc.lines, doc.row, doc.col, orow, ocol); int base = indentOf(doc.lines[nested ? orow : doc.row]); int indent = nested ? base + settings.tabSize : base; doc.noteEdit(doc.row, doc.col, doc.row, (int)doc.lines[doc.row].size()); std::string cur = doc.lines[doc.row]; std::string rest = cur.substr(doc.col); rest.erase(0, indentOf(rest)); doc.lines[doc.row] = cur.substr(0, doc.col); bool closes = nested && !rest.empty() && BracketIndex::isClose(rest[0]); if (closes && orow == doc.row && ocol == doc.col - 1) { doc.lines.insert(doc.lines.begin() + doc.row + 1, std::string(base, ' ') + rest); doc.lines.insert(doc.lines.begin() + doc.row + 1, std::string(indent, ' ')); doc.row++; doc.col = indent; } else { if (closes) indent = base; doc.lines.insert(doc.lines.begin() + doc.row + 1, std::string(indent, ' ') + rest); doc.row++; doc.col = indent; } doc.touch(startRow, 1, 1 + (int)doc.lines.size() - before, (int)doc.lines[startRow].size()); return; } if (key == KEY_TAB && !ctrl) { if (!ev.repeat) pushUndo(); deleteSelection(doc); doc.noteEdit(doc.row, doc.col, doc.row, doc.col); doc.lines[doc.row].insert(doc.col, std::string(settings.tabSize, ' ')); doc.col += settings.tabSize; doc.touch(doc.row, 1, 1, doc.col - settings.tabSize, (int)doc.lines[doc.row].size() - doc.col); return; } bool page = key == KEY_PAGE_UP || key == KEY_PAGE_DOWN; if (!page && key != KEY_LEFT && key != KEY_RIGHT && key != KEY_UP && key != KEY_DOWN && key != KEY_HOME && key != KEY_END) return; if (shift && !doc.selecting) { doc.selecting = true; doc.selRowStart = doc.row; doc.selColStart = doc.col; } if (!shift && !doc.selecting) clearSelection(doc); int vrBefore = page ? visualRow(doc, doc.row, doc.col) : 0; switch (key) { case KEY_LEFT: moveLeft(doc, ctrl); break; case KEY_RIGHT: moveRight(doc, ctrl); break; case KEY_UP: moveVertical(doc, -1); break; case KEY_DOWN: moveVertical(doc, 1); break; case KEY_PAGE_UP: moveVertical(doc, -viewRows); break; case KEY_PAGE_DOWN: moveVertical(doc, viewRows); break; case KEY_HOME: if (ctrl) doc.row = 0; doc.col = 0; break; case KEY_END: if (ctrl) doc.row = (int)doc.lines.size() - 1; doc.col = (int)doc.lines[doc.row].size(); break; } if (page) doc.scroll = std::max(0, doc.scroll + visualRow(doc, doc.row, doc.col) - vrBefore); if (shift && doc.selecting) { doc.selRowEnd = doc.row; doc.selColEnd = doc.col; } if (!shift && doc.selecting) clearSelection(doc); completionDoc = -1; }
+void Editor::handlePointer(Document& doc, Rectangle bounds, const InputEvent& ev) { float tabH = Config::TAB_HEIGHT; Rectangle contentR = {bounds.x, bounds.y + tabH, bounds.width, bounds.height - tabH}; Rectangle mapR = {contentR.x + contentR.width - Minimap::WIDTH, contentR.y, (float)Minimap::WIDTH, contentR.height}; if (ev.type == InputEvent::MouseUp) { minimapDrag = false; if (CheckCollisionPointRec(ev.pos, contentR) && doc.selRowStart == doc.selRowEnd && doc.selColStart == doc.selColEnd) clearSelection(doc); return; } completionDoc = -1; if (handleTabBar(bounds, ev.pos)) return; Document& active = currentDoc(); if (!active.isResident()) return; if (settings.showMinimap && CheckCollisionPointRec(ev.pos, mapR)) { minimapDrag = true; dragPointer(active, bounds); return; } if (!CheckCollisionPointRec(ev.pos, contentR)) return; int r, c; hitTest(active, (int)((ev.pos.y - contentR.y) / lineHeight) + active.scroll, (int)round((ev.pos.x - contentR.x - gutterWidthFor(active)) / charWidth), r, c); if (ev.ctrl) { gotoDefinition(wordAt(active, r, c)); return; } active.row = r; active.col = c; active.selecting = true; active.selRowStart = r; active.selColStart = c; active.selRowEnd = r; active.selColEnd = c; }
+// Held-button state between presses: minimap scrubbing and drag selection.
+void Editor::dragPointer(Document& doc, Rectangle bounds) { if (!Input::IsMouseButtonDown(MOUSE_LEFT_BUTTON)) { minimapDrag = false; return; } Vector2 m = Input::GetMousePosition(); float tabH = Config::TAB_HEIGHT; Rectangle contentR = {bounds.x, bounds.y + tabH, bounds.width, bounds.height - tabH}; Rectangle mapR = {contentR.x + contentR.width - Minimap::WIDTH, contentR.y, (float)Minimap::WIDTH, contentR.height}; if (minimapDrag) { if (settings.showMinimap) doc.scroll = std::max(0, visualRow(doc, minimap.lineAt(mapR, m.y), 0) - viewRows / 2); return; } if (!doc.selecting || !CheckCollisionPointRec(m, contentR)) return; int r, c; hitTest(doc, (int)((m.y - contentR.y) / lineHeight) + doc.scroll, (int)round((m.x - contentR.x - gutterWidthFor(doc)) / charWidth), r, c); doc.selRowEnd = r; doc.selColEnd = c; doc.row = r; doc.col = c; }
+void Editor::render(Rectangle bounds) { float tabH = Config::TAB_HEIGHT; Vector2 mouse = Input::GetMousePosition(); float tabX = bounds.x; for (int i=0; i<docs.size(); i++) { const char* title = frameArena.format("%s%s", docs[i]->filename.c_str(), docs[i]->isDirty ? "*" : docs[i]->following ? " (tail)" : ""); float textW = MeasureTextEx(font, title, Config::FONT_SIZE_UI, 1).x; float tabW = textW + 40; Rectangle tabRect = {tabX, bounds.y, tabW, tabH}; bool isHover = CheckCollisionPointRec(mouse, tabRect); DrawRectangleRec(tabRect, (i==activeTab) ? theme.tabActive : theme.tabInactive); if (i==activeTab) DrawRectangle((int)tabX, (int)bounds.y, (int)tabW, 2, theme.keyword); Color titleColor = (i==activeTab) ? theme.tabTextActive : GRAY; DrawTextEx(font, title, {tabX+10, bounds.y+5}, Config::FONT_SIZE_UI, 1, titleColor); if (isHover) DrawTextEx(font, "x", {tabX + tabW - 20, bounds.y + 5}, 18, 1, theme.closeBtn); DrawLine((int)(tabX+tabW), (int)bounds.y, (int)(tabX+tabW), (int)(bounds.y+tabH), theme.border); tabX += tabW + 2; } DrawRectangle((int)tabX, (int)bounds.y, (int)(bounds.width-(tabX-bounds.x)), (int)tabH, theme.panelBg); Rectangle content = {bounds.x, bounds.y+tabH, bounds.width, bounds.height-tabH}; Document& doc = currentDoc(); DrawRectangleRec(content, theme.bg); if (!doc.isResident()) { DrawTextEx(font, frameArena.format("Restoring %s...", doc.filename.c_str()), {content.x + 20, content.y + 20}, Config::FONT_SIZE_UI, 1, theme.lineNumber); return; } BeginScissorMode((int)content.x, (int)content.y, (int)content.width, (int)content.height); rowSalt = std::hash<std::string_view>()(std::string_view((const char*)&theme, sizeof(Theme))); float gutterWidth = 0.0f; if (settings.showLineNumbers) { int maxLines = (int)doc.lines.size(); int digits = (maxLines == 0) ? 1 : (int)log10(maxLines) + 1; gutterWidth = digits * charWidth + Config::GUTTER_PADDING; DrawRectangleRec({content.x, content.y, gutterWidth, content.height}, theme.gutterBg); DrawLine(content.x + gutterWidth, content.y, content.x + gutterWidth, content.y + content.height, theme.border); } int vis = (int)(content.height / lineHeight) + 1; int idx = doc.scroll, sub = 0; size_t segEnd = 0; if (doc.wrap.enabled) { doc.wrap.find(doc.scroll, idx, sub); segEnd = doc.columns.offset(doc.lines[idx], idx, doc.wrap.rowStart(doc.lines[idx], idx, sub)); } for (int i=0; i<vis; i++) { if (idx >= doc.lines.size()) break; int yPos = (int)(content.y + i*lineHeight); LineChange change = doc.diff.changeAt(idx); if (change == LineChange::Added || change == LineChange::Modified) DrawRectangle((int)(content.x + gutterWidth) + 1, yPos, 3, lineHeight, change == LineChange::Added ? theme.runButton : theme.keyword); else if (change == LineChange::DeletedAbove && sub == 0) DrawTriangle({content.x + gutterWidth + 1, (float)yPos - 4}, {content.x + gutterWidth + 1, (float)yPos + 4}, {content.x + gutterWidth + 5, (float)yPos}, theme.closeBtn); if (settings.showLineNumbers && sub == 0) { const char* num = frameArena.format("%d", idx + 1); float tw = MeasureTextEx(font, num, settings.fontSize, 1.0f).x; textBatch.text(font, num, {content.x + gutterWidth - tw - 10, (float)yPos}, settings.fontSize, 1.0f, theme.lineNumber); } if (doc.wrap.enabled) { const std::string& text = doc.lines[idx]; size_t segStart = segEnd; segEnd = doc.columns.offset(text, idx, doc.wrap.rowEnd(text, idx, sub)); drawLine(doc, idx, (int)(content.x + gutterWidth + 5), yPos, (int)segStart, (int)segEnd); if (++sub >= doc.wrap.rowsOf(idx)) { idx++; sub = 0; segEnd = 0; } } else { const std::string& text = doc.lines[idx]; size_t from = doc.columns.offset(text, idx, doc.scrollCol); drawLine(doc, idx, (int)(content.x + gutterWidth + 5), yPos, (int)from, (int)doc.columns.offset(text, idx, doc.scrollCol + viewCols + 1)); idx++; } } textBatch.flush(); if (matchRow >= 0 && braceRow < (int)doc.lines.size() && matchRow < (int)doc.lines.size()) { int marks[2][2] = {{braceRow, braceCol}, {matchRow, matchCol}}; for (auto& mk : marks) { int vr; float bx; if (!caretPos(doc, mk[0], mk[1], vr, bx)) continue; float bw = MeasureTextEx(font, frameArena.str(std::string_view(doc.lines[mk[0]]).substr(mk[1], 1)), settings.fontSize, 1.0f).x; int by = (int)(content.y + (vr - doc.scroll) * lineHeight); if (by >= content.y - lineHeight && by < content.y + content.height) DrawRectangleLines((int)(content.x + gutterWidth + 5 + bx) - 1, by, (int)bw + 2, lineHeight, theme.lineNumber); } } int vr; float cursorX; if (showCursor && caretPos(doc, doc.row, doc.col, vr, cursorX)) { int cx = (int)(content.x + gutterWidth + 5 + cursorX); int cy = (int)(content.y + (vr - doc.scroll) * lineHeight); if (cy >= content.y && cy < content.y + content.height) DrawRectangle(cx, cy, 2, lineHeight, theme.cursor); } if (settings.showMinimap) { int topLine = doc.scroll, topSub = 0; if (doc.wrap.enabled) doc.wrap.find(doc.scroll, topLine, topSub); minimap.render({content.x + content.width - Minimap::WIDTH, content.y, (float)Minimap::WIDTH, content.height}, topLine, topLine + (int)(content.height / lineHeight)); } EndScissorMode(); if (gotoOpen) { const char* prompt = frameArena.format("Go to line: %s_", gotoInput.c_str()); Rectangle box = {content.x + content.width - 260, content.y + 5, 250, 30}; DrawRectangleRec(box, theme.panelBg); DrawRectangleLinesEx(box, 1, theme.keyword); DrawTextEx(font, prompt, {box.x + 8, box.y + 5}, Config::FONT_SIZE_UI, 1, theme.text); } if (outlineOpen && !outlineItems.empty()) { float itemH = Config::FONT_SIZE_UI + 6; int shown = std::min((int)outlineItems.size(), std::max(1, (int)((content.height - 20) / itemH))); int first = Clamp(outlineSel - shown / 2, 0, (int)outlineItems.size() - shown); Rectangle box = {content.x + content.width - 330, content.y + 5, 320, itemH * shown + 10}; DrawRectangleRec(box, theme.panelBg); DrawRectangleLinesEx(box, 1, theme.keyword); for (int i = 0; i < shown; i++) { const SymbolHit& h = outlineItems[first + i]; float iy = box.y + 5 + i * itemH; if (first + i == outlineSel) DrawRectangle((int)box.x + 1, (int)iy, (int)box.width - 2, (int)itemH, theme.selection); DrawTextEx(font, frameArena.format("%c  %s", h.kind, h.name.c_str()), {box.x + 8, iy + 3}, Config::FONT_SIZE_UI, 1, h.kind == 'f' ? theme.text : theme.type); const char* ln = frameArena.format("%d", h.line); DrawTextEx(font, ln, {box.x + box.width - 10 - MeasureTextEx(font, ln, Config::FONT_SIZE_UI, 1).x, iy + 3}, Config::FONT_SIZE_UI, 1, theme.lineNumber); } } if (completionDoc == doc.id && !completions.empty() && caretPos(doc, doc.row, doc.col, vr, cursorX)) { float px = content.x + gutterWidth + 5 + cursorX; float py = content.y + (vr - doc.scroll + 1) * lineHeight; float itemH = Config::FONT_SIZE_UI + 6; float popW = 0; for (const std::string& w : completions) popW = std::max(popW, MeasureTextEx(font, w.c_str(), Config::FONT_SIZE_UI, 1).x); Rectangle box = {px, py, popW + 16, itemH * completions.size()}; DrawRectangleRec(box, theme.panelBg); DrawRectangleLinesEx(box, 1, theme.border); for (int i = 0; i < (int)completions.size(); i++) { if (i == completionSel) DrawRectangle((int)box.x, (int)(box.y + i * itemH), (int)box.width, (int)itemH, theme.selection); DrawTextEx(font, completions[i].c_str(), {box.x + 8, box.y + i * itemH + 3}, Config::FONT_SIZE_UI, 1, theme.text); } } if (latencyOverlay) { float p50, p95, p99; input.percentiles(p50, p95, p99); float budget = 1000.0f / std::max(1, GetFPS()); const TextBatch::Stats& ts = textBatch.lastFrame(); const char* stats = frameArena.format("input p50 %.1f  p95 %.1f  p99 %.1f ms  (%d)  frame %.1f ms  allocs %zu/%zu  arena %zu KB\ntext %zu calls -> %zu draws, %zu quads  rows %zu reused / %zu built", p50, p95, p99, (int)input.sampleCount(), Input::GetFrameTime() * 1000.0f, frameStats.allocations, frameStats.allAllocations, frameStats.arenaBytes / 1024, ts.calls, ts.draws, ts.quads, ts.rowsReused, ts.rowsBuilt); Vector2 area = MeasureTextEx(font, stats, Config::FONT_SIZE_UI, 1); float tw = area.x; Rectangle box = {content.x + content.width - tw - 20 - (settings.showMinimap ? Minimap::WIDTH : 0), content.y + content.height - area.y - 14, tw + 12, area.y + 8}; DrawRectangleRec(box, theme.panelBg); DrawRectangleLinesEx(box, 1, p99 > budget ? theme.closeBtn : theme.border); DrawTextEx(font, stats, {box.x + 6, box.y + 4}, Config::FONT_SIZE_UI, 1, p99 > budget ? theme.closeBtn : theme.text); } }
+void Editor::endFrame() { input.presented(); }
+void Editor::drawLine(const Document& doc, int lineIdx, int x, int y, int byteStart, int byteEnd) { const std::string& full = doc.lines[lineIdx]; bool tail = byteEnd < 0 || byteEnd >= (int)full.size(); std::string_view text = std::string_view(full).substr(byteStart, tail ? std::string_view::npos : byteEnd - byteStart); float cx = (float)x; if (hasSelection(doc)) { int r1, c1, r2, c2; normalizeSelection(r1, c1, r2, c2, doc); c1 = Clamp(c1 - byteStart, 0, (int)text.size()); c2 = Clamp(c2 - byteStart, 0, (int)text.size()); if (lineIdx >= r1 && lineIdx <= r2) { float startX = 0, width = 0; float all = MeasureTextEx(font, frameArena.str(text), settings.fontSize, 1.0f).x; if (lineIdx == r1) startX = MeasureTextEx(font, frameArena.str(text.substr(0, c1)), settings.fontSize, 1.0f).x; if (lineIdx == r2) width = MeasureTextEx(font, frameArena.str(text.substr(0, c2)), settings.fontSize, 1.0f).x - startX; else width = all - startX + (tail ? 10 : 0); if (lineIdx > r1 && lineIdx < r2) { startX = 0; width = all + (tail ? 10 : 0); } DrawRectangle((int)(cx + startX), y, (int)width, lineHeight, theme.selection); } } size_t end = byteStart + text.size(), first = byteStart, last = end; while (first > 0 && full[first - 1] != ' ' && full[first - 1] != '\t') first--; while (last < full.size() && full[last] != ' ' && full[last] != '\t') last++; uint64_t clipped = ((uint64_t)(byteStart - first) << 32) | (last - end); if (textBatch.reuseRow(TextBatch::rowKey(std::string_view(full).substr(first, last - first), {cx, (float)y}, font, (float)settings.fontSize, rowSalt ^ clipped))) return; size_t pos = first; while (pos < end) { size_t nextSpace = std::min(full.find_first_of(" \t", pos), full.size()); Color c = Highlighter::colorOf(highlighter->classify(full.data() + pos, nextSpace - pos)); size_t from = std::max(pos, (size_t)byteStart), to = std::min(nextSpace, end); if (to > from) cx += textBatch.text(font, std::string_view(full).substr(from, to - from), {cx, (float)y}, (float)settings.fontSize, 1.0f, c); if (nextSpace < end) { cx += textBatch.text(font, std::string_view(full).substr(nextSpace, 1), {cx, (float)y}, (float)settings.fontSize, 1.0f, theme.text); pos = nextSpace + 1; } else pos = nextSpace; } textBatch.endRow(); }
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "../include/Encoding.hpp"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CTOM_SSE2 1
+#endif
+
+static constexpr size_t SNIFF_BYTES = 4096;
+
+const char* EncodingName(TextEncoding enc) {
+    switch (enc) {
+        case TextEncoding::Utf8: return "UTF-8";
+        case TextEncoding::Utf8Bom: return "UTF-8 with BOM";
+        case TextEncoding::Utf16LE: return "UTF-16 LE";
+        case TextEncoding::Utf16BE: return "UTF-16 BE";
+        case TextEncoding::Latin1: return "Latin-1";
+    }
+    return "";
+}
+
+// Length of the ASCII prefix of [p, p+len).
+static size_t AsciiPrefix(const unsigned char* p, size_t len) {
+    size_t i = 0;
+#ifdef CTOM_SSE2
+    for (; i + 64 <= len; i += 64) {
+        __m128i a = _mm_or_si128(_mm_loadu_si128((const __m128i*)(p + i)), _mm_loadu_si128((const __m128i*)(p + i + 16)));
+        __m128i b = _mm_or_si128(_mm_loadu_si128((const __m128i*)(p + i + 32)), _mm_loadu_si128((const __m128i*)(p + i + 48)));
+        if (_mm_movemask_epi8(_mm_or_si128(a, b))) break;
+    }
+    for (; i + 16 <= len; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(p + i)));
+        if (mask) {
+            for (; !(mask & 1); mask >>= 1) i++;
+            return i;
+        }
+    }
+#else
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        if (w & 0x8080808080808080ull) break;
+    }
+#endif
+    while (i < len && p[i] < 0x80) i++;
+    return i;
+}
+
+// One UTF-8 sequence at p; returns its length, or 0 if it is malformed,
+// overlong, a surrogate or past U+10FFFF.
+static size_t DecodeUtf8(const unsigned char* p, size_t avail, uint32_t& cp) {
+    unsigned char c = p[0];
+    if (c < 0x80) { cp = c; return 1; }
+    size_t n;
+    uint32_t min;
+    if ((c & 0xE0) == 0xC0) { n = 2; cp = c & 0x1F; min = 0x80; }
+    else if ((c & 0xF0) == 0xE0) { n = 3; cp = c & 0x0F; min = 0x800; }
+    else if ((c & 0xF8) == 0xF0) { n = 4; cp = c & 0x07; min = 0x10000; }
+    else return 0;
+    if (n > avail) return 0;
+    for (size_t i = 1; i < n; i++) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+    return n;
+}
+
+static void PutUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) out += (char)cp;
+    else if (cp < 0x800) { out += (char)(0xC0 | (cp >> 6)); out += (char)(0x80 | (cp & 0x3F)); }
+    else if (cp < 0x10000) { out += (char)(0xE0 | (cp >> 12)); out += (char)(0x80 | ((cp >> 6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+    else { out += (char)(0xF0 | (cp >> 18)); out += (char)(0x80 | ((cp >> 12) & 0x3F)); out += (char)(0x80 | ((cp >> 6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+}
+
+bool IsValidUtf8(const char* data, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    size_t i = 0;
+    uint32_t cp;
+    while (i < len) {
+        i += AsciiPrefix(p + i, len - i);
+        // Non-ASCII text tends to come in runs; stay scalar until the next ASCII byte.
+        while (i < len && p[i] >= 0x80) {
+            size_t n = DecodeUtf8(p + i, len - i, cp);
+            if (!n) return false;
+            i += n;
+        }
+    }
+    return true;
+}
+
+TextEncoding DetectEncoding(const char* data, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    if (len >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) return TextEncoding::Utf8Bom;
+    if (len >= 2 && p[0] == 0xFF && p[1] == 0xFE) return TextEncoding::Utf16LE;
+    if (len >= 2 && p[0] == 0xFE && p[1] == 0xFF) return TextEncoding::Utf16BE;
+
+    // BOM-less UTF-16 of mostly Latin text: one byte of nearly every pair is zero.
+    size_t sniff = std::min(len, SNIFF_BYTES) & ~(size_t)1;
+    if (sniff >= 4) {
+        size_t evenZero = 0, oddZero = 0;
+        for (size_t i = 0; i < sniff; i += 2) { evenZero += p[i] == 0; oddZero += p[i + 1] == 0; }
+        size_t pairs = sniff / 2;
+        if (oddZero * 10 > pairs * 4 && evenZero * 20 < pairs) return TextEncoding::Utf16LE;
+        if (evenZero * 10 > pairs * 4 && oddZero * 20 < pairs) return TextEncoding::Utf16BE;
+    }
+    return IsValidUtf8(data, len) ? TextEncoding::Utf8 : TextEncoding::Latin1;
+}
+
+static void DecodeLatin1(const unsigned char* p, size_t len, std::string& out) {
+    out.reserve(len + len / 8);
+    size_t i = 0;
+    while (i < len) {
+        size_t run = AsciiPrefix(p + i, len - i);
+        out.append((const char*)p + i, run);
+        for (i += run; i < len && p[i] >= 0x80; i++) PutUtf8(out, p[i]);
+    }
+}
+
+static void DecodeUtf16(const unsigned char* p, size_t len, bool bigEndian, std::string& out) {
+    size_t units = len / 2, i = 0;
+    out.reserve(units + units / 8);
+    auto unit = [&](size_t k) -> uint32_t { return bigEndian ? (p[2 * k] << 8) | p[2 * k + 1] : p[2 * k] | (p[2 * k + 1] << 8); };
+    while (i < units) {
+#ifdef CTOM_SSE2
+        // Eight ASCII code units narrow to eight bytes in one pack.
+        const __m128i high = _mm_set1_epi16((short)0xFF80);
+        char buf[16];
+        while (i + 8 <= units) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(p + 2 * i));
+            if (bigEndian) v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, high), _mm_setzero_si128())) != 0xFFFF) break;
+            _mm_storeu_si128((__m128i*)buf, _mm_packus_epi16(v, v));
+            out.append(buf, 8);
+            i += 8;
+        }
+#endif
+        // Scalar until the next ASCII unit.
+        do {
+            if (i >= units) break;
+            uint32_t u = unit(i++);
+            if (u >= 0xD800 && u <= 0xDBFF && i < units && unit(i) >= 0xDC00 && unit(i) <= 0xDFFF) u = 0x10000 + ((u - 0xD800) << 10) + (unit(i++) - 0xDC00);
+            else if (u >= 0xD800 && u <= 0xDFFF) u = 0xFFFD;
+            PutUtf8(out, u);
+        } while (i < units && unit(i) >= 0x80);
+    }
+    if (len & 1) PutUtf8(out, 0xFFFD);
+}
+
+std::string DecodeText(const char* data, size_t len, TextEncoding enc) {
+    const unsigned char* p = (const unsigned char*)data;
+    std::string out;
+    switch (enc) {
+        case TextEncoding::Utf8: out.assign(data, len); break;
+        case TextEncoding::Utf8Bom: out.assign(data + 3, len - 3); break;
+        case TextEncoding::Utf16LE: case TextEncoding::Utf16BE: {
+            bool be = enc == TextEncoding::Utf16BE;
+            bool bom = len >= 2 && ((be && p[0] == 0xFE && p[1] == 0xFF) || (!be && p[0] == 0xFF && p[1] == 0xFE));
+            DecodeUtf16(p + (bom ? 2 : 0), len - (bom ? 2 : 0), be, out);
+            break;
+        }
+        case TextEncoding::Latin1: DecodeLatin1(p, len, out); break;
+    }
+    return out;
+}
+
+static void PutUtf16(std::string& out, uint32_t u, bool bigEndian) {
+    char b[2] = { (char)(bigEndian ? u >> 8 : u & 0xFF), (char)(bigEndian ? u & 0xFF : u >> 8) };
+    out.append(b, 2);
+}
+
+bool EncodeText(const std::string& utf8, TextEncoding enc, bool bom, std::string& out) {
+    const unsigned char* p = (const unsigned char*)utf8.data();
+    size_t len = utf8.size(), i = 0;
+    uint32_t cp;
+    out.clear();
+    if (enc == TextEncoding::Utf8 || enc == TextEncoding::Utf8Bom) {
+        if (enc == TextEncoding::Utf8Bom) out = "\xEF\xBB\xBF";
+        out += utf8;
+        return true;
+    }
+    if (enc == TextEncoding::Latin1) {
+        out.reserve(len);
+        while (i < len) {
+            size_t run = AsciiPrefix(p + i, len - i);
+            out.append((const char*)p + i, run);
+            i += run;
+            while (i < len && p[i] >= 0x80) {
+                size_t n = DecodeUtf8(p + i, len - i, cp);
+                if (!n || cp > 0xFF) return false;
+                out += (char)cp;
+                i += n;
+            }
+        }
+        return true;
+    }
+    bool be = enc == TextEncoding::Utf16BE;
+    out.reserve(2 * len + 2);
+    if (bom) PutUtf16(out, 0xFEFF, be);
+    while (i < len) {
+#ifdef CTOM_SSE2
+        // Sixteen ASCII bytes widen to sixteen code units by interleaving with zero.
+        char buf[32];
+        while (i + 16 <= len) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+            if (_mm_movemask_epi8(v)) break;
+            __m128i z = _mm_setzero_si128();
+            _mm_storeu_si128((__m128i*)buf, be ? _mm_unpacklo_epi8(z, v) : _mm_unpacklo_epi8(v, z));
+            _mm_storeu_si128((__m128i*)(buf + 16), be ? _mm_unpackhi_epi8(z, v) : _mm_unpackhi_epi8(v, z));
+            out.append(buf, 32);
+            i += 16;
+        }
+#endif
+        if (i >= len) break;
+        size_t n = DecodeUtf8(p + i, len - i, cp);
+        if (!n) { cp = 0xFFFD; n = 1; }
+        if (cp >= 0x10000) {
+            PutUtf16(out, 0xD800 + ((cp - 0x10000) >> 10), be);
+            PutUtf16(out, 0xDC00 + ((cp - 0x10000) & 0x3FF), be);
+        } else PutUtf16(out, cp, be);
+        i += n;
+    }
+    return true;
+}
+
+static void SplitLines(const char* p, size_t len, std::vector<std::string>& lines, FileFormat& format) {
+    lines.clear();
+    const char* end = p + len;
+    const char* nl = (const char*)memchr(p, '\n', len);
+    format.eol = (nl && nl > p && nl[-1] == '\r') ? LineEnding::CRLF : LineEnding::LF;
+    format.finalNewline = len > 0 && end[-1] == '\n';
+    while (p < end) {
+        nl = (const char*)memchr(p, '\n', end - p);
+        const char* stop = nl ? nl : end;
+        size_t n = stop - p;
+        if (n > 0 && p[n - 1] == '\r') n--;
+        lines.emplace_back(p, n);
+        p = nl ? nl + 1 : end;
+    }
+    if (lines.empty()) lines.push_back("");
+}
+
+static bool ReadRaw(const std::string& path, std::string& raw) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    in.seekg(0, std::ios::end);
+    std::streamoff size = in.tellg();
+    in.seekg(0, std::ios::beg);
+    if (size > 0) {
+        raw.resize((size_t)size);
+        in.read(&raw[0], size);
+        raw.resize((size_t)in.gcount());
+    } else raw.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool ReadTextFile(const std::string& path, std::vector<std::string>& lines, FileFormat& format) {
+    std::string raw;
+    if (!ReadRaw(path, raw)) return false;
+    format.encoding = DetectEncoding(raw.data(), raw.size());
+    const unsigned char* head = (const unsigned char*)raw.data();
+    format.bom = raw.size() >= 2 && ((format.encoding == TextEncoding::Utf16LE && head[0] == 0xFF && head[1] == 0xFE) ||
+                                     (format.encoding == TextEncoding::Utf16BE && head[0] == 0xFE && head[1] == 0xFF));
+    if (format.encoding == TextEncoding::Utf8) SplitLines(raw.data(), raw.size(), lines, format);
+    else if (format.encoding == TextEncoding::Utf8Bom) SplitLines(raw.data() + 3, raw.size() - 3, lines, format);
+    else {
+        std::string text = DecodeText(raw.data(), raw.size(), format.encoding);
+        std::string().swap(raw);
+        SplitLines(text.data(), text.size(), lines, format);
+    }
+    return true;
+}
+
+bool ReadTextFile(const std::string& path, std::string& text) {
+    if (!ReadRaw(path, text)) return false;
+    TextEncoding enc = DetectEncoding(text.data(), text.size());
+    if (enc == TextEncoding::Utf8Bom) text.erase(0, 3);
+    else if (enc != TextEncoding::Utf8) text = DecodeText(text.data(), text.size(), enc);
+    return true;
+}
+
+bool ReadTextFile(const std::string& path, std::vector<std::string>& lines) {
+    FileFormat format;
+    return ReadTextFile(path, lines, format);
+}
+
+bool WriteTextFile(const std::string& path, const std::vector<std::string>& lines, FileFormat& format) {
+    const char* eol = format.eol == LineEnding::CRLF ? "\r\n" : "\n";
+    size_t total = 0;
+    for (const std::string& l : lines) total += l.size() + 2;
+    std::string text;
+    text.reserve(total);
+    for (size_t i = 0; i < lines.size(); i++) {
+        text += lines[i];
+        if (i + 1 < lines.size() || format.finalNewline) text += eol;
+    }
+    // UTF-8 is written straight from the joined text; only other encodings need a second buffer.
+    std::string out;
+    bool utf8 = format.encoding == TextEncoding::Utf8 || format.encoding == TextEncoding::Utf8Bom;
+    if (!utf8 && !EncodeText(text, format.encoding, format.bom, out)) {
+        format.encoding = TextEncoding::Utf8;
+        utf8 = true;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    if (format.encoding == TextEncoding::Utf8Bom) file.write("\xEF\xBB\xBF", 3);
+    if (utf8) file.write(text.data(), text.size());
+    else file.write(out.data(), out.size());
+    return file.good();
+}
@@ -1,4 +1,6 @@
 #include "../include/FileManager.hpp"
+#include "../include/Session.hpp"
+#include "../include/TextBatch.hpp"
 
 void FileManager::init() { 
     isLoaded = false; 
@@ -23,6 +25,7 @@ void FileManager::openFolderDialog() {
     std::string path = OpenWindowsFolderPicker();
     if (!path.empty()) { 
         currentPath = path; 
+        openedFolder = path;
         isLoaded = true; 
         scrollIndex = 0; 
         refresh(); 
@@ -34,22 +37,39 @@ void FileManager::openFileDialog() {
     if (!path.empty()) selectedFile = path;
 }
 
+// Directories are read on a worker; the old listing stays up until the new one lands.
+// Navigating again, or destroying the FileManager, cancels a read still in flight.
 void FileManager::refresh() {
     if (!isLoaded) return;
-    entries.clear();
-    try {
-        for (const auto& entry : fs::directory_iterator(currentPath)) entries.push_back(entry);
-        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
-            if (a.is_directory() != b.is_directory()) return a.is_directory();
-            return a.path().filename() < b.path().filename();
-        });
-    } catch (...) { isLoaded = false; }
+    listing.reset();
+    struct Listing {
+        std::vector<Entry> entries;
+        bool failed = false;
+    };
+    std::shared_ptr<Listing> result = std::make_shared<Listing>();
+    fs::path dir = currentPath;
+    JobSystem::instance().submit("files.list", JobPriority::Interactive, [result, dir]() {
+        try {
+            for (const auto& entry : fs::directory_iterator(dir)) result->entries.push_back({entry.path(), entry.path().filename().string(), entry.is_directory()});
+            std::sort(result->entries.begin(), result->entries.end(), [](const Entry& a, const Entry& b) {
+                if (a.isDir != b.isDir) return a.isDir;
+                return a.name < b.name;
+            });
+        } catch (...) { result->failed = true; }
+    }, listing.token(), [this, result]() {
+        if (result->failed) { isLoaded = false; entries.clear(); return; }
+        entries = std::move(result->entries);
+    });
 }
 
 std::string FileManager::popSelectedFile() {
     std::string s = selectedFile; selectedFile = ""; return s;
 }
 
+std::string FileManager::popOpenedFolder() {
+    std::string s = openedFolder; openedFolder = ""; return s;
+}
+
 void FileManager::update(Rectangle bounds, bool isFocused) {
     // Offset for Header Height (25px)
     float headerH = 25.0f;
@@ -57,27 +77,27 @@ void FileManager::update(Rectangle bounds, bool isFocused) {
 
     if (isLoaded) {
         if (isFocused) {
-            float wheel = GetMouseWheelMove();
+            float wheel = Input::GetMouseWheelMove();
             scrollIndex -= (int)wheel; if (scrollIndex < 0) scrollIndex = 0;
         }
-        if (isFocused && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-            Vector2 m = GetMousePosition();
+        if (isFocused && Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            Vector2 m = Input::GetMousePosition();
             if (CheckCollisionPointRec(m, contentBounds)) {
                 int idx = (int)((m.y - contentBounds.y) / itemHeight) + scrollIndex;
                 if (idx == 0) { if (currentPath.has_parent_path()) { currentPath = currentPath.parent_path(); scrollIndex = 0; refresh(); } }
                 else {
                     int eIdx = idx - 1;
                     if (eIdx >= 0 && eIdx < (int)entries.size()) {
-                        if (entries[eIdx].is_directory()) { currentPath = entries[eIdx].path(); scrollIndex = 0; refresh(); }
-                        else selectedFile = entries[eIdx].path().string();
+                        if (entries[eIdx].isDir) { currentPath = entries[eIdx].path; scrollIndex = 0; refresh(); }
+                        else selectedFile = entries[eIdx].path.string();
                     }
                 }
             }
         }
     } else {
-        Vector2 m = GetMousePosition();
+        Vector2 m = Input::GetMousePosition();
         Rectangle btnRect = {contentBounds.x + 10, contentBounds.y + 10, 120, 30};
-        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(m, btnRect)) openFolderDialog();
+        if (Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(m, btnRect)) openFolderDialog();
     }
 }
 
@@ -98,19 +118,19 @@ void FileManager::render(Rectangle bounds, Font font) {
         if (!isLoaded) {
             DrawTextEx(font, "No Folder.", {contentRect.x + 10, contentRect.y + 10}, Config::FONT_SIZE_UI, 1, GRAY);
             Rectangle btnRect = {contentRect.x + 10, contentRect.y + 40, 120, 30};
-            bool hover = CheckCollisionPointRec(GetMousePosition(), btnRect);
+            bool hover = CheckCollisionPointRec(Input::GetMousePosition(), btnRect);
             DrawRectangleRec(btnRect, hover ? theme.btnNormal : theme.border);
             DrawTextEx(font, "Open Folder", {btnRect.x + 10, btnRect.y + 5}, 18, 1, WHITE);
         } else {
-            float y = contentRect.y; float x = contentRect.x + 5; Vector2 mouse = GetMousePosition();
+            float y = contentRect.y; float x = contentRect.x + 5; Vector2 mouse = Input::GetMousePosition();
             
             Rectangle upRect = {contentRect.x, y, contentRect.width, itemHeight};
             if (CheckCollisionPointRec(mouse, upRect)) DrawRectangleRec(upRect, theme.fileHover);
             
             if (folderIcon.id > 0) DrawTexture(folderIcon, (int)x, (int)y + 2, WHITE);
-            else DrawTextEx(font, "^", {x, y}, Config::FONT_SIZE_UI, 1, theme.keyword);
+            else textBatch.text(font, "^", {x, y}, Config::FONT_SIZE_UI, 1, theme.keyword);
             
-            DrawTextEx(font, "..", {x + 25, y}, Config::FONT_SIZE_UI, 1, theme.keyword); 
+            textBatch.text(font, "..", {x + 25, y}, Config::FONT_SIZE_UI, 1, theme.keyword); 
             
             for (int i = 0; i < entries.size(); i++) {
                 float dy = y + (i + 1 - scrollIndex) * itemHeight;
@@ -119,17 +139,18 @@ void FileManager::render(Rectangle bounds, Font font) {
                 Rectangle itemRect = {contentRect.x, dy, contentRect.width, itemHeight};
                 if (CheckCollisionPointRec(mouse, itemRect)) DrawRectangleRec(itemRect, theme.fileHover);
                 
-                std::string n = entries[i].path().filename().string();
-                bool isDir = entries[i].is_directory();
+                const std::string& n = entries[i].name;
+                bool isDir = entries[i].isDir;
                 Color c = isDir ? theme.folder : theme.text;
                 float textX = x;
                 
                 if (isDir && folderIcon.id > 0) { DrawTexture(folderIcon, (int)x, (int)dy + 2, WHITE); textX += 25; } 
-                else if (isDir) { DrawTextEx(font, "[D]", {x, dy}, Config::FONT_SIZE_UI, 1, theme.keyword); textX += 35; } 
+                else if (isDir) { textBatch.text(font, "[D]", {x, dy}, Config::FONT_SIZE_UI, 1, theme.keyword); textX += 35; } 
                 else { textX += 25; }
 
-                DrawTextEx(font, n.c_str(), {textX, dy}, Config::FONT_SIZE_UI, 1, c);
+                textBatch.text(font, n, {textX, dy}, Config::FONT_SIZE_UI, 1, c);
             }
         }
+        textBatch.flush();
     EndScissorMode();
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "../include/Follower.hpp"
+#include "../include/JobSystem.hpp"
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+Follower::~Follower() {
+#ifdef __linux__
+    if (notifyFd >= 0) close(notifyFd);
+#endif
+}
+
+// identity is 0 where there is no inode to compare; then only shrinking counts as a reset.
+bool Follower::statFile(const std::string& path, uint64_t& identity, uint64_t& size) {
+#ifdef _WIN32
+    std::error_code ec;
+    uintmax_t n = fs::file_size(path, ec);
+    if (ec) return false;
+    identity = 0;
+    size = n;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    identity = ((uint64_t)st.st_dev << 40) ^ (uint64_t)st.st_ino;
+    size = (uint64_t)st.st_size;
+#endif
+    return true;
+}
+
+void Follower::start(const Document& doc) {
+    stop(doc.id);
+    Watch w;
+    w.docId = doc.id;
+    w.path = doc.path;
+    w.name = fs::path(doc.path).filename().string();
+    w.encoding = doc.format.encoding;
+    w.token = doc.lifetime.token();
+    w.endsWithNewline = doc.format.finalNewline;
+
+    // Size of the buffer as the file stores it; the first read checks it lines up.
+    uint64_t bytes = doc.format.encoding == TextEncoding::Utf8Bom ? 3 : 0;
+    for (const std::string& line : doc.lines) bytes += doc.format.encoding == TextEncoding::Latin1 ? Utf8Length(line) : line.size();
+    size_t breaks = doc.lines.size() - (doc.format.finalNewline ? 0 : 1);
+    bytes += breaks * (doc.format.eol == LineEnding::CRLF ? 2 : 1);
+    w.offset = bytes;
+
+#ifdef __linux__
+    if (notifyFd < 0) notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd >= 0) {
+        std::string dir = fs::path(doc.path).parent_path().string();
+        w.wd = inotify_add_watch(notifyFd, dir.empty() ? "." : dir.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+    }
+#endif
+    watches.push_back(std::move(w));
+}
+
+void Follower::stop(int docId) {
+    for (size_t i = 0; i < watches.size(); i++) {
+        if (watches[i].docId != docId) continue;
+#ifdef __linux__
+        // Watches on one directory share a descriptor.
+        int wd = watches[i].wd;
+        bool shared = false;
+        for (size_t k = 0; k < watches.size(); k++) shared |= k != i && watches[k].wd == wd;
+        if (wd >= 0 && !shared) inotify_rm_watch(notifyFd, wd);
+#endif
+        watches.erase(watches.begin() + i);
+        return;
+    }
+}
+
+void Follower::readEvents() {
+#ifdef __linux__
+    if (notifyFd < 0) return;
+    alignas(struct inotify_event) char buf[4096];
+    while (true) {
+        ssize_t n = read(notifyFd, buf, sizeof(buf));
+        if (n <= 0) break;
+        for (char* p = buf; p < buf + n;) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            for (Watch& w : watches) {
+                if (ev->mask & IN_Q_OVERFLOW) w.changed = true;
+                else if (ev->wd == w.wd && ev->len > 0 && w.name == ev->name) w.changed = true;
+                if ((ev->mask & IN_IGNORED) && ev->wd == w.wd) w.wd = -1;
+            }
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+#endif
+}
+
+// Worker side: stat, decide between appending and starting over, read one chunk.
+void Follower::run(Read& r) {
+    uint64_t identity, size;
+    if (!statFile(r.path, identity, size)) { r.missing = true; return; }
+    std::ifstream in(r.path, std::ios::binary);
+    if (!in) { r.missing = true; return; }
+
+    bool reset = (r.identity != 0 && identity != r.identity) || size < r.offset;
+    if (!reset && r.verify && r.offset > 0) {
+        char last = 0;
+        in.seekg((std::streamoff)(r.offset - 1));
+        in.read(&last, 1);
+        reset = !in || (last == '\n') != r.endsWithNewline;
+        in.clear();
+    }
+    r.identity = identity;
+    if (reset) {
+        r.chunk.reset = true;
+        r.offset = size > RESYNC_TAIL ? size - RESYNC_TAIL : 0;
+        r.chunk.skippedHead = r.offset > 0;
+    }
+    r.next = r.offset;
+    if (size <= r.offset) return;
+
+    size_t n = (size_t)std::min<uint64_t>(MAX_CHUNK, size - r.offset);
+    std::string data(n, '\0');
+    in.seekg((std::streamoff)r.offset);
+    in.read(&data[0], (std::streamsize)n);
+    data.resize((size_t)in.gcount());
+    r.next = r.offset + data.size();
+    r.more = r.next < size;
+
+    size_t from = 0;
+    if (r.chunk.skippedHead) {
+        // Started mid-line: the partial first line is not shown.
+        size_t nl = data.find('\n');
+        from = nl == std::string::npos ? data.size() : nl + 1;
+    } else if (r.chunk.reset && data.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        from = 3;
+    }
+    if (r.encoding == TextEncoding::Latin1) data = DecodeText(data.data() + from, data.size() - from, TextEncoding::Latin1);
+    else data.erase(0, from);
+
+    const char* p = data.data();
+    const char* end = p + data.size();
+    while (true) {
+        const char* nl = (const char*)memchr(p, '\n', end - p);
+        const char* stop = nl ? nl : end;
+        size_t len = stop - p;
+        if (nl && len > 0 && p[len - 1] == '\r') len--;
+        r.chunk.pieces.emplace_back(p, len);
+        if (!nl) break;
+        p = nl + 1;
+    }
+}
+
+void Follower::update(float dt, const std::function<void(int docId, FollowChunk& chunk)>& apply) {
+    readEvents();
+    sinceStat += dt;
+    bool poll = sinceStat >= (notifyFd >= 0 ? STAT_INTERVAL : POLL_INTERVAL);
+    if (poll) sinceStat = 0.0f;
+
+    for (Watch& w : watches) {
+        if (w.read && w.read->done) {
+            std::shared_ptr<Read> r = std::move(w.read);
+            if (!r->missing) {
+                w.offset = r->next;
+                w.identity = r->identity;
+                w.verify = false;
+                if (r->chunk.reset || r->next > r->offset) apply(w.docId, r->chunk);
+                w.changed |= r->more;
+            }
+        }
+        w.changed |= poll;
+        if (w.read || !w.changed) continue;
+        w.changed = false;
+        std::shared_ptr<Read> r = std::make_shared<Read>();
+        r->path = w.path;
+        r->encoding = w.encoding;
+        r->offset = w.offset;
+        r->identity = w.identity;
+        r->verify = w.verify;
+        r->endsWithNewline = w.endsWithNewline;
+        w.read = r;
+        JobSystem::instance().submit("follow.read", JobPriority::Background, [r]() { run(*r); r->done = true; }, w.token);
+    }
+}
@@ -0,0 +1,148 @@
+#include "../include/FontCache.hpp"
+#include <filesystem>
+#include "../include/JobSystem.hpp"
+#include <cstdio>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+static const uint32_t FONT_CACHE_MAGIC = 0x43465443; // "CTFC"
+static const uint32_t FONT_CACHE_VERSION = 1;
+static const int FONT_ATLAS_PADDING = 4;           // matches raylib's LoadFontEx
+static const int MAX_ATLAS_SIDE = 16384;
+
+static bool ReadWholeFile(const std::string& path, std::vector<unsigned char>& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !out.empty();
+}
+
+std::string FontCache::keyFor(const std::string& dir, const std::vector<unsigned char>& ttf, int size, int glyphCount) {
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    for (unsigned char c : ttf) { h ^= c; h *= 1099511628211ULL; }
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%016llx-%d-%d.bin", (unsigned long long)h, size, glyphCount);
+    return dir + "/" + buf;
+}
+
+// Entries are only trusted as far as they check out: a cut-off or corrupt
+// file fails here instead of sizing allocations or the texture upload.
+bool FontCache::readCache(const std::string& file, int size, int glyphCount, Baked& out) {
+    FILE* f = fopen(file.c_str(), "rb");
+    if (!f) return false;
+    uint32_t hdr[5] = {0};
+    bool ok = fread(hdr, sizeof(uint32_t), 5, f) == 5 && hdr[0] == FONT_CACHE_MAGIC && hdr[1] == FONT_CACHE_VERSION && hdr[2] == (uint32_t)size && hdr[4] == (uint32_t)glyphCount;
+    if (ok) {
+        out.baseSize = size; out.glyphPadding = (int)hdr[3];
+        out.recs.resize(glyphCount); out.glyphs.assign(glyphCount, GlyphInfo{});
+        for (int i = 0; ok && i < glyphCount; i++) {
+            int32_t m[4];
+            ok = fread(&out.recs[i], sizeof(Rectangle), 1, f) == 1 && fread(m, sizeof(int32_t), 4, f) == 4;
+            if (!ok) break;
+            out.glyphs[i].value = m[0]; out.glyphs[i].offsetX = m[1]; out.glyphs[i].offsetY = m[2]; out.glyphs[i].advanceX = m[3];
+        }
+        int32_t a[3]; uint32_t bytes = 0;
+        ok = ok && fread(a, sizeof(int32_t), 3, f) == 3 && fread(&bytes, sizeof(uint32_t), 1, f) == 1;
+        ok = ok && a[0] > 0 && a[0] <= MAX_ATLAS_SIDE && a[1] > 0 && a[1] <= MAX_ATLAS_SIDE && a[2] >= PIXELFORMAT_UNCOMPRESSED_GRAYSCALE && a[2] <= PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        ok = ok && bytes == (uint32_t)GetPixelDataSize(a[0], a[1], a[2]);
+        if (ok) {
+            out.atlasWidth = a[0]; out.atlasHeight = a[1]; out.atlasFormat = a[2];
+            out.pixels.resize(bytes);
+            ok = fread(out.pixels.data(), 1, bytes, f) == bytes;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+void FontCache::writeCache(const std::string& dir, const std::string& file, const Baked& b) {
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    std::string tmp = file + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return;
+    uint32_t hdr[5] = { FONT_CACHE_MAGIC, FONT_CACHE_VERSION, (uint32_t)b.baseSize, (uint32_t)b.glyphPadding, (uint32_t)b.recs.size() };
+    fwrite(hdr, sizeof(uint32_t), 5, f);
+    for (size_t i = 0; i < b.recs.size(); i++) {
+        int32_t m[4] = { b.glyphs[i].value, b.glyphs[i].offsetX, b.glyphs[i].offsetY, b.glyphs[i].advanceX };
+        fwrite(&b.recs[i], sizeof(Rectangle), 1, f);
+        fwrite(m, sizeof(int32_t), 4, f);
+    }
+    int32_t a[3] = { b.atlasWidth, b.atlasHeight, b.atlasFormat };
+    uint32_t bytes = (uint32_t)b.pixels.size();
+    fwrite(a, sizeof(int32_t), 3, f);
+    fwrite(&bytes, sizeof(uint32_t), 1, f);
+    fwrite(b.pixels.data(), 1, bytes, f);
+    fclose(f);
+    fs::rename(tmp, file, ec);
+}
+
+// CPU-only part of LoadFontEx: safe to run off the main thread.
+bool FontCache::bake(const std::string& dir, const std::string& path, int size, int glyphCount, Baked& out) {
+    std::vector<unsigned char> ttf;
+    if (!ReadWholeFile(path, ttf)) return false;
+    std::string file = keyFor(dir, ttf, size, glyphCount);
+    if (readCache(file, size, glyphCount, out)) return true;
+
+    GlyphInfo* glyphs = LoadFontData(ttf.data(), (int)ttf.size(), size, NULL, glyphCount, FONT_DEFAULT);
+    if (!glyphs) return false;
+    Rectangle* recs = NULL;
+    Image atlas = GenImageFontAtlas(glyphs, &recs, glyphCount, size, FONT_ATLAS_PADDING, 0);
+
+    out.baseSize = size; out.glyphPadding = FONT_ATLAS_PADDING;
+    out.recs.assign(recs, recs + glyphCount);
+    out.glyphs.resize(glyphCount);
+    for (int i = 0; i < glyphCount; i++) { out.glyphs[i] = glyphs[i]; out.glyphs[i].image = Image{ 0 }; }
+    out.atlasWidth = atlas.width; out.atlasHeight = atlas.height; out.atlasFormat = atlas.format;
+    const unsigned char* px = (const unsigned char*)atlas.data;
+    out.pixels.assign(px, px + GetPixelDataSize(atlas.width, atlas.height, atlas.format));
+
+    UnloadImage(atlas);
+    RL_FREE(recs);
+    UnloadFontData(glyphs, glyphCount);
+    writeCache(dir, file, out);
+    return true;
+}
+
+Font FontCache::upload(Baked& b) {
+    Font font = { 0 };
+    int count = (int)b.recs.size();
+    font.baseSize = b.baseSize; font.glyphCount = count; font.glyphPadding = b.glyphPadding;
+    font.recs = (Rectangle*)RL_MALLOC(count * sizeof(Rectangle));
+    font.glyphs = (GlyphInfo*)RL_CALLOC(count, sizeof(GlyphInfo));
+    memcpy(font.recs, b.recs.data(), count * sizeof(Rectangle));
+    memcpy(font.glyphs, b.glyphs.data(), count * sizeof(GlyphInfo));
+    Image atlas = { b.pixels.data(), b.atlasWidth, b.atlasHeight, 1, b.atlasFormat };
+    font.texture = LoadTextureFromImage(atlas);
+    return font;
+}
+
+bool FontCache::loadCached(const std::string& path, int size, int glyphCount, Font& out) {
+    std::vector<unsigned char> ttf;
+    if (!ReadWholeFile(path, ttf)) return false;
+    Baked b;
+    if (!readCache(keyFor(dir, ttf, size, glyphCount), size, glyphCount, b)) return false;
+    out = upload(b);
+    return true;
+}
+
+void FontCache::requestAsync(const std::string& path, int size, int glyphCount) {
+    // Only the newest request is kept; an older one is cancelled if it has not started.
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->path = path; job->size = size; job->glyphCount = glyphCount;
+    pending = job;
+    superseded.reset();
+    JobSystem::instance().submit("font.bake", JobPriority::Interactive, [cacheDir = dir, job]() {
+        job->ok = bake(cacheDir, job->path, job->size, job->glyphCount, job->baked);
+        job->done = true;
+    }, superseded.token());
+}
+
+bool FontCache::poll(Font& out, bool& failed) {
+    if (!pending || !pending->done) return false;
+    failed = !pending->ok;
+    if (pending->ok) out = upload(pending->baked);
+    pending.reset();
+    return true;
+}
@@ -0,0 +1,63 @@
+#include "../include/FrameArena.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+FrameArena frameArena;
+FrameStats frameStats;
+
+static std::atomic<size_t> totalAllocations{0};
+static thread_local size_t threadAllocations = 0;
+
+size_t ThreadAllocationCount() { return threadAllocations; }
+size_t TotalAllocationCount() { return totalAllocations.load(std::memory_order_relaxed); }
+
+// The array and nothrow forms forward here, so this sees every allocation
+// that goes through new.
+void* operator new(size_t size) {
+    threadAllocations++;
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+char* FrameArena::alloc(size_t bytes) {
+    while (current < blocks.size() && used + bytes > blocks[current].size) { current++; used = 0; }
+    if (current == blocks.size()) blocks.push_back({std::make_unique<char[]>(std::max(BLOCK_SIZE, bytes)), std::max(BLOCK_SIZE, bytes)});
+    char* p = blocks[current].data.get() + used;
+    used += bytes;
+    total += bytes;
+    return p;
+}
+
+void FrameArena::reset() {
+    blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [](const Block& b) { return b.size > BLOCK_SIZE; }), blocks.end());
+    current = 0;
+    used = 0;
+    total = 0;
+}
+
+const char* FrameArena::str(std::string_view s) {
+    char* p = alloc(s.size() + 1);
+    memcpy(p, s.data(), s.size());
+    p[s.size()] = '\0';
+    return p;
+}
+
+const char* FrameArena::format(const char* fmt, ...) {
+    va_list args, measure;
+    va_start(args, fmt);
+    va_copy(measure, args);
+    int n = vsnprintf(nullptr, 0, fmt, measure);
+    va_end(measure);
+    char* p = alloc(std::max(n, 0) + 1);
+    vsnprintf(p, std::max(n, 0) + 1, fmt, args);
+    va_end(args);
+    return p;
+}
@@ -0,0 +1,184 @@
+#include "../include/Hibernator.hpp"
+#include "../include/Lz.hpp"
+#include "../include/JobSystem.hpp"
+
+static void PutU32(std::string& out, uint32_t v) {
+    char b[4] = { (char)(v & 0xFF), (char)((v >> 8) & 0xFF), (char)((v >> 16) & 0xFF), (char)((v >> 24) & 0xFF) };
+    out.append(b, 4);
+}
+
+static bool GetU32(const std::string& in, size_t& pos, uint32_t& v) {
+    if (pos + 4 > in.size()) return false;
+    const unsigned char* p = (const unsigned char*)in.data() + pos;
+    v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    pos += 4; return true;
+}
+
+static void PutLines(std::string& out, const std::vector<std::string>& lines) {
+    PutU32(out, (uint32_t)lines.size());
+    for (const std::string& l : lines) { PutU32(out, (uint32_t)l.size()); out += l; }
+}
+
+static bool GetLines(const std::string& in, size_t& pos, std::vector<std::string>& lines) {
+    uint32_t count, len;
+    if (!GetU32(in, pos, count)) return false;
+    lines.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (!GetU32(in, pos, len) || pos + len > in.size()) return false;
+        lines.emplace_back(in, pos, len);
+        pos += len;
+    }
+    return true;
+}
+
+static size_t SerializedSize(const std::vector<std::string>& lines) {
+    size_t n = 4 + 4 * lines.size();
+    for (const std::string& l : lines) n += l.size();
+    return n;
+}
+
+size_t Hibernator::footprint(const std::vector<std::string>& lines) {
+    static const size_t inlineCap = std::string().capacity();
+    size_t n = lines.capacity() * sizeof(std::string);
+    for (const std::string& l : lines) if (l.capacity() > inlineCap) n += l.capacity() + 1;
+    return n;
+}
+
+size_t Hibernator::residentBytes(Document& doc) {
+    if (doc.residency == Residency::Packed && doc.parked) return doc.parked->blob.capacity();
+    if (!doc.isResident()) return 0;
+    if (doc.bytesStale) {
+        doc.bytes = footprint(doc.lines);
+        for (const UndoState& u : doc.undoStack) doc.bytes += footprint(u.lines);
+        doc.bytesStale = false;
+    }
+    return doc.bytes;
+}
+
+void Hibernator::pack(std::shared_ptr<ParkedText> job) {
+    size_t raw = 4 + SerializedSize(job->lines);
+    for (const UndoState& u : job->undo) raw += 24 + SerializedSize(u.lines);
+    std::string buf;
+    buf.reserve(raw);
+    PutLines(buf, job->lines);
+    PutU32(buf, (uint32_t)job->undo.size());
+    for (const UndoState& u : job->undo) {
+        for (int v : {u.row, u.col, u.first, u.keepHead, u.linesAfter, u.keepTail}) PutU32(buf, (uint32_t)v);
+        PutLines(buf, u.lines);
+    }
+    std::vector<std::string>().swap(job->lines);
+    std::deque<UndoState>().swap(job->undo);
+    job->rawSize = buf.size();
+    job->blob = LzCompress(buf.data(), buf.size());
+    job->blob.shrink_to_fit();
+    job->done = true;
+}
+
+void Hibernator::unpack(std::shared_ptr<ParkedText> job) {
+    if (!job->path.empty()) {
+        job->failed = !ReadTextFile(job->path, job->lines, job->format);
+        job->done = true;
+        return;
+    }
+    std::string buf;
+    size_t pos = 0;
+    uint32_t count, v[6];
+    bool ok = LzDecompress(job->blob, buf, job->rawSize) && GetLines(buf, pos, job->lines) && GetU32(buf, pos, count);
+    for (uint32_t i = 0; ok && i < count; i++) {
+        for (uint32_t& x : v) ok = ok && GetU32(buf, pos, x);
+        UndoState u{(int)v[0], (int)v[1], (int)v[2], (int)v[3], (int)v[4], (int)v[5]};
+        ok = ok && GetLines(buf, pos, u.lines);
+        if (ok) job->undo.push_back(std::move(u));
+    }
+    std::string().swap(job->blob);
+    job->failed = !ok;
+    job->done = true;
+}
+
+void Hibernator::dropCaches(Document& doc) {
+    if (doc.wrap.enabled) { int line, sub; doc.wrap.find(doc.scroll, line, sub); doc.scroll = line; doc.wrap.enabled = false; }
+    doc.wrap.clear();
+    doc.brackets.clear();
+    doc.columns.clear();
+    doc.version++;
+}
+
+void Hibernator::install(Document& doc, std::vector<std::string>&& lines, std::deque<UndoState>&& undo) {
+    doc.lines = std::move(lines);
+    if (doc.lines.empty()) doc.lines.push_back("");
+    doc.undoStack = std::move(undo);
+    doc.row = Clamp(doc.row, 0, (int)doc.lines.size() - 1);
+    doc.col = Clamp(doc.col, 0, (int)doc.lines[doc.row].size());
+    doc.selRowStart = -1; doc.selecting = false;
+    doc.residency = Residency::Resident;
+    doc.bytesStale = true;
+    dropCaches(doc);
+}
+
+void Hibernator::park(Document& doc) {
+    dropCaches(doc);
+    if (!doc.isDirty && !doc.path.empty() && doc.undoStack.empty() && !doc.partialView) {
+        std::vector<std::string>(1, "").swap(doc.lines);
+        doc.residency = Residency::Dropped;
+    } else {
+        std::shared_ptr<ParkedText> job = std::make_shared<ParkedText>();
+        job->lines.swap(doc.lines);
+        job->undo.swap(doc.undoStack);
+        doc.lines.assign(1, "");
+        doc.parked = job;
+        doc.residency = Residency::Packing;
+        JobSystem::instance().submit("hibernate.pack", JobPriority::Background, [job]() { pack(job); }, doc.lifetime.token());
+    }
+    doc.bytes = 0;
+    doc.bytesStale = true;
+}
+
+void Hibernator::wake(Document& doc) {
+    std::shared_ptr<ParkedText> job = (doc.residency == Residency::Packed) ? doc.parked : std::make_shared<ParkedText>();
+    if (doc.residency == Residency::Dropped) job->path = doc.path;
+    job->done = false;
+    doc.parked = job;
+    doc.residency = Residency::Unpacking;
+    JobSystem::instance().submit("hibernate.unpack", JobPriority::Interactive, [job]() { unpack(job); }, doc.lifetime.token());
+}
+
+void Hibernator::update(std::vector<std::unique_ptr<Document>>& docs, int active, float dt, const std::function<void(Document& doc)>& reread) {
+    for (std::unique_ptr<Document>& d : docs) {
+        Document& doc = *d;
+        if (doc.residency == Residency::Packing && doc.parked->done) doc.residency = Residency::Packed;
+        if (doc.residency == Residency::Unpacking && doc.parked->done) {
+            std::shared_ptr<ParkedText> job = std::move(doc.parked);
+            if (job->failed) { ShowToast("Could not restore " + doc.filename); job->lines.clear(); job->undo.clear(); }
+            install(doc, std::move(job->lines), std::move(job->undo));
+            // The file may have changed on disk while it was dropped.
+            if (!job->path.empty() && !job->failed) {
+                doc.format = job->format;
+                doc.diff.reset(doc.lines);
+                reread(doc);
+            }
+        }
+    }
+    if (active < 0 || active >= (int)docs.size()) return;
+    Document& current = *docs[active];
+    markActive(current);
+    if (current.residency == Residency::Packed || current.residency == Residency::Dropped) wake(current);
+
+    timer += dt;
+    if (timer < CHECK_INTERVAL) return;
+    timer = 0.0f;
+    // The active document's size is only re-measured once it goes inactive;
+    // walking its undo snapshots every second would cost more than it saves.
+    size_t budget = (size_t)settings.memoryBudgetMB << 20;
+    size_t total = current.bytes;
+    for (int i = 0; i < (int)docs.size(); i++) if (i != active) total += residentBytes(*docs[i]);
+    while (total > budget) {
+        int victim = -1;
+        for (int i = 0; i < (int)docs.size(); i++) {
+            if (i == active || !docs[i]->isResident() || docs[i]->following) continue;
+            if (victim < 0 || docs[i]->lastActive < docs[victim]->lastActive) victim = i;
+        }
+        if (victim < 0) break;
+        total -= std::min(total, docs[victim]->bytes);
+        park(*docs[victim]);
+    }
+}
@@ -0,0 +1,41 @@
+#include "../include/Highlighter.hpp"
+#include <cstring>
+
+void Highlighter::init() {
+    keywords = {"if", "else", "while", "for", "return", "using", "namespace", "class", "true", "false", "new", "delete", "include", "void", "int", "float", "double", "bool", "char", "string", "vector", "auto", "template", "typename", "const", "static", "public", "private", "std"};
+    types = {"Editor", "FileManager", "Terminal", "Theme", "Document", "vector", "string", "map", "uint8_t", "cout", "cin", "endl"};
+}
+
+TokenKind Highlighter::classify(const char* word, size_t len) const {
+    if (len == 0) return TokenKind::Text;
+    std::string_view w(word, len);
+    if (keywords.count(w)) return TokenKind::Keyword;
+    if (types.count(w)) return TokenKind::Type;
+    if (isdigit((unsigned char)word[0])) return TokenKind::Number;
+    if (len >= 2 && word[0] == '/' && word[1] == '/') return TokenKind::Comment;
+    if (memchr(word, '"', len)) return TokenKind::String;
+    return TokenKind::Text;
+}
+
+void Highlighter::tokenize(const std::string& line, std::vector<TokenSpan>& out, size_t maxBytes) const {
+    out.clear();
+    size_t end = std::min(line.size(), maxBytes);
+    size_t pos = 0;
+    while (pos < end) {
+        size_t next = line.find_first_of(" \t", pos);
+        if (next == std::string::npos || next > end) next = end;
+        if (next > pos) out.push_back({(int)pos, (int)next, classify(line.data() + pos, next - pos)});
+        pos = next + 1;
+    }
+}
+
+Color Highlighter::colorOf(TokenKind kind) {
+    switch (kind) {
+        case TokenKind::Keyword: return theme.keyword;
+        case TokenKind::Type: return theme.type;
+        case TokenKind::Number: return theme.number;
+        case TokenKind::Comment: return theme.comment;
+        case TokenKind::String: return theme.string;
+        default: return theme.text;
+    }
+}
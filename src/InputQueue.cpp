@@ -0,0 +1,103 @@
+#include "../include/InputQueue.hpp"
+#include "../include/Session.hpp"
+#include <chrono>
+
+// Latency is real time even when a session replays input on its own clock.
+static double WallClock() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool ProducesChar(int key) {
+    return (key >= KEY_SPACE && key <= KEY_GRAVE) || (key >= KEY_KP_0 && key <= KEY_KP_EQUAL);
+}
+
+void InputQueue::push(InputEvent::Type type, int code, double time, bool ctrl, bool shift, bool repeat) {
+    InputEvent ev{};
+    ev.type = type;
+    ev.code = code;
+    ev.time = time;
+    ev.ctrl = ctrl;
+    ev.shift = shift;
+    ev.repeat = repeat;
+    ev.pos = Input::GetMousePosition();
+    events.push_back(ev);
+}
+
+void InputQueue::collect() {
+    events.clear();
+    double now = Input::GetTime();
+    double wall = WallClock();
+    double sincePoll = lastPoll > 0 ? wall - lastPoll : 0;
+    lastPoll = wall;
+    bool ctrl = Input::IsKeyDown(KEY_LEFT_CONTROL) || Input::IsKeyDown(KEY_RIGHT_CONTROL);
+    bool shift = Input::IsKeyDown(KEY_LEFT_SHIFT) || Input::IsKeyDown(KEY_RIGHT_SHIFT);
+    double delay = std::max(50, settings.keyRepeatDelayMs) / 1000.0;
+    double interval = 1.0 / std::max(1, settings.keyRepeatRate);
+
+    // Repeats fell due during the last frame, before anything polled with it.
+    for (int i = 0; i < REPEAT_COUNT; i++) {
+        int key = REPEAT_KEYS[i];
+        if (!Input::IsKeyDown(key)) { due[i] = 0; continue; }
+        if (Input::IsKeyPressed(key) || due[i] == 0) { due[i] = now + delay; continue; }
+        for (int n = 0; due[i] <= now && n < MAX_REPEATS_PER_FRAME; n++) {
+            push(InputEvent::Key, key, due[i], ctrl, shift, true);
+            due[i] += interval;
+        }
+        // After a long stall, replay a bounded burst and skip the rest.
+        if (due[i] <= now) due[i] = now + interval;
+    }
+    std::stable_sort(events.begin(), events.end(), [](const InputEvent& a, const InputEvent& b) { return a.time < b.time; });
+
+    if (Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) push(InputEvent::MouseDown, MOUSE_LEFT_BUTTON, now, ctrl, shift);
+    std::vector<int> chars;
+    for (int c = Input::GetCharPressed(); c > 0; c = Input::GetCharPressed()) chars.push_back(c);
+    size_t nextChar = 0;
+    for (int key = Input::GetKeyPressed(); key > 0; key = Input::GetKeyPressed()) {
+        push(InputEvent::Key, key, now, ctrl, shift);
+        if (!ctrl && ProducesChar(key) && nextChar < chars.size()) push(InputEvent::Char, chars[nextChar++], now, ctrl, shift);
+    }
+    // Characters without a key press this frame: OS auto-repeat, IME, dead keys.
+    for (; nextChar < chars.size(); nextChar++) push(InputEvent::Char, chars[nextChar], now, ctrl, shift);
+    float wheel = Input::GetMouseWheelMove();
+    if (wheel != 0) {
+        push(InputEvent::Wheel, 0, now, ctrl, shift);
+        events.back().wheel = wheel;
+    }
+    if (Input::IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) push(InputEvent::MouseUp, MOUSE_LEFT_BUTTON, now, ctrl, shift);
+
+    for (const InputEvent& ev : events) {
+        if (ev.type == InputEvent::MouseUp) continue;
+        double age = now - ev.time;
+        if (!ev.repeat) age = std::max(age, sincePoll);
+        unpresented.push_back(wall - age);
+    }
+}
+
+// Events stay with whoever has focus; drop ours and forget held keys.
+void InputQueue::clear() {
+    events.clear();
+    for (double& d : due) d = 0;
+}
+
+void InputQueue::presented() {
+    double now = WallClock();
+    if (!unpresented.empty()) latencies.reserve(SAMPLE_WINDOW);      // grown once, not while the window fills
+    for (double t : unpresented) {
+        float ms = (float)((now - t) * 1000.0);
+        if (latencies.size() < SAMPLE_WINDOW) latencies.push_back(ms);
+        else latencies[nextSample] = ms;
+        nextSample = (nextSample + 1) % SAMPLE_WINDOW;
+    }
+    unpresented.clear();
+}
+
+void InputQueue::percentiles(float& p50, float& p95, float& p99) const {
+    p50 = p95 = p99 = 0;
+    if (latencies.empty()) return;
+    std::vector<float> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](float q) { return sorted[std::min(sorted.size() - 1, (size_t)(q * sorted.size()))]; };
+    p50 = at(0.50f);
+    p95 = at(0.95f);
+    p99 = at(0.99f);
+}
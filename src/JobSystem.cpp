@@ -0,0 +1,144 @@
+#include "../include/JobSystem.hpp"
+
+static thread_local int currentWorker = -1;
+
+JobSystem& JobSystem::instance() {
+    static JobSystem system;
+    return system;
+}
+
+JobSystem::JobSystem() {
+    int count = std::max(2, (int)std::thread::hardware_concurrency() - 1);
+    for (int i = 0; i < count; i++) workers.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < count; i++) workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() { shutdown(); }
+
+// Jobs still queued are dropped; running ones finish first.
+void JobSystem::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMtx);
+        if (stopping) return;
+        stopping = true;
+    }
+    wake.notify_all();
+    idle.notify_all();
+    for (auto& w : workers) if (w->thread.joinable()) w->thread.join();
+    for (auto& w : workers) { w->lanes[0].clear(); w->lanes[1].clear(); }
+    std::lock_guard<std::mutex> lock(finishedMtx);
+    finished.clear();
+}
+
+// From a worker the job stays local to it; from anywhere else it goes round robin.
+void JobSystem::submit(const char* name, JobPriority priority, Task work, CancelToken token, Task done) {
+    Job job;
+    job.name = name;
+    job.priority = priority;
+    job.work = std::move(work);
+    job.done = std::move(done);
+    job.token = std::move(token);
+    job.queuedAt = std::chrono::steady_clock::now();
+    unfinished++;
+    int target = currentWorker >= 0 ? currentWorker : (int)(nextWorker++ % workers.size());
+    {
+        std::lock_guard<std::mutex> lock(workers[target]->mtx);
+        workers[target]->lanes[(int)priority].push_back(std::move(job));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMtx);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+// A background slot is claimed before looking for background work, so two
+// workers can't both pass the cap check and both start one.
+bool JobSystem::take(int self, Job& out) {
+    int n = (int)workers.size();
+    for (int lane = 0; lane < 2; lane++) {
+        bool background = lane == (int)JobPriority::Background;
+        if (background) {
+            int running = backgroundRunning.load();
+            do {
+                if (running >= n - 1) return false;
+            } while (!backgroundRunning.compare_exchange_weak(running, running + 1));
+        }
+        for (int k = 0; k < n; k++) {
+            Worker& w = *workers[(self + k) % n];
+            std::lock_guard<std::mutex> lock(w.mtx);
+            std::deque<Job>& q = w.lanes[lane];
+            if (q.empty()) continue;
+            if (k == 0) { out = std::move(q.back()); q.pop_back(); }
+            else { out = std::move(q.front()); q.pop_front(); }
+            queued--;
+            return true;
+        }
+        if (background) backgroundRunning--;
+    }
+    return false;
+}
+
+void JobSystem::run(Job& job) {
+    auto start = std::chrono::steady_clock::now();
+    bool cancelled = job.token.cancelled();
+    if (!cancelled) job.work();
+    auto end = std::chrono::steady_clock::now();
+    if (job.priority == JobPriority::Background) backgroundRunning--;
+
+    Finished f;
+    f.done = std::move(job.done);
+    f.token = std::move(job.token);
+    f.timing.name = job.name;
+    f.timing.priority = job.priority;
+    f.timing.waitMs = std::chrono::duration<float, std::milli>(start - job.queuedAt).count();
+    f.timing.runMs = std::chrono::duration<float, std::milli>(end - start).count();
+    f.timing.cancelled = cancelled;
+    {
+        std::lock_guard<std::mutex> lock(finishedMtx);
+        finished.push_back(std::move(f));
+    }
+    if (--unfinished == 0) {
+        std::lock_guard<std::mutex> lock(sleepMtx);
+        idle.notify_all();
+    }
+}
+
+void JobSystem::workerLoop(int self) {
+    currentWorker = self;
+    Job job;
+    while (true) {
+        if (take(self, job)) {
+            bool background = job.priority == JobPriority::Background;
+            run(job);
+            job = Job();
+            // A finished background job may unblock one held back by the reserve.
+            if (background) wake.notify_one();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMtx);
+        if (stopping) return;
+        // Work may be queued but only in the background lane while it is at its cap.
+        if (queued.load() > 0) wake.wait_for(lock, std::chrono::milliseconds(5));
+        else wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        if (stopping) return;
+    }
+}
+
+// Jobs submitted by running jobs are waited for too. Returns at once after shutdown().
+void JobSystem::waitIdle() {
+    std::unique_lock<std::mutex> lock(sleepMtx);
+    idle.wait(lock, [this] { return stopping || unfinished.load() == 0; });
+}
+
+void JobSystem::drainCompletions() {
+    std::vector<Finished> batch;
+    {
+        std::lock_guard<std::mutex> lock(finishedMtx);
+        batch.swap(finished);
+    }
+    for (Finished& f : batch) {
+        if (f.done && !f.token.cancelled()) f.done();
+        if (timingHook) timingHook(f.timing);
+    }
+}
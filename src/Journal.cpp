@@ -0,0 +1,328 @@
+#include "../include/Journal.hpp"
+#include "../include/Encoding.hpp"
+#include "../include/LineDiff.hpp"
+#include <filesystem>
+#include <chrono>
+#include <random>
+#ifdef _WIN32
+    #include <io.h>
+    #include <process.h>
+    #include <share.h>
+    #define JOURNAL_FSYNC(f) _commit(_fileno(f))
+#else
+    #include <unistd.h>
+    #include <sys/file.h>
+    #define JOURNAL_FSYNC(f) fsync(fileno(f))
+#endif
+
+namespace fs = std::filesystem;
+
+static void PutU32(std::string& out, uint32_t v) {
+    char b[4] = { (char)(v & 0xFF), (char)((v >> 8) & 0xFF), (char)((v >> 16) & 0xFF), (char)((v >> 24) & 0xFF) };
+    out.append(b, 4);
+}
+
+static bool GetU32(const std::string& in, size_t& pos, uint32_t& v) {
+    if (pos + 4 > in.size()) return false;
+    const unsigned char* p = (const unsigned char*)in.data() + pos;
+    v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    pos += 4; return true;
+}
+
+static std::vector<std::string> ReadLinesFromDisk(const std::string& path) {
+    std::vector<std::string> lines;
+    if (!ReadTextFile(path, lines)) lines.push_back("");
+    return lines;
+}
+
+// Creates a journal that is already locked, so no other instance ever finds
+// it unlocked. POSIX locks a temporary name first and renames it into place.
+static FILE* CreateLocked(const std::string& path) {
+#ifdef _WIN32
+    return _fsopen(path.c_str(), "wb", _SH_DENYWR);
+#else
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return nullptr;
+    if (flock(fileno(f), LOCK_EX | LOCK_NB) != 0 || rename(tmp.c_str(), path.c_str()) != 0) { fclose(f); remove(tmp.c_str()); return nullptr; }
+    return f;
+#endif
+}
+
+// Opens a journal for reading and takes its lock; null while its instance still runs.
+static FILE* TryLock(const std::string& path) {
+#ifdef _WIN32
+    return _fsopen(path.c_str(), "rb", _SH_DENYRW);
+#else
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f && flock(fileno(f), LOCK_EX | LOCK_NB) != 0) { fclose(f); return nullptr; }
+    return f;
+#endif
+}
+
+// Deletes a journal this instance holds. POSIX unlinks it before letting go of
+// the lock so nobody can take it in between; Windows can't delete an open file.
+static void RemoveHeld(FILE* f, const std::string& path) {
+    std::error_code ec;
+#ifdef _WIN32
+    fclose(f);
+    fs::remove(path, ec);
+#else
+    fs::remove(path, ec);
+    fclose(f);
+#endif
+}
+
+static std::string NewSession() {
+    std::random_device rd;
+#ifdef _WIN32
+    int pid = _getpid();
+#else
+    int pid = (int)getpid();
+#endif
+    char name[40];
+    snprintf(name, sizeof(name), "%d-%08x%08x", pid, (unsigned)rd(), (unsigned)rd());
+    return name;
+}
+
+// Applies a journal's records to its base text: 'S' replaces whole lines, 'P'
+// replaces them with a paste's lines stored as one blob, 'B' the bytes between
+// a kept head and tail of one line. Returns how many were
+// applied, or -1 if the base text is not the one it was recorded against or
+// a record doesn't fit. A record cut off by the crash just ends the replay.
+static int Replay(const std::string& data, RecoveredDoc& doc) {
+    bool hasHeader = false; int applied = 0;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        char type = data[pos++];
+        uint32_t a, b, c;
+        if (type == 'H' && !hasHeader) {
+            if (pos + 1 > data.size()) break;
+            bool fromDisk = data[pos++] != 0;
+            if (!GetU32(data, pos, a) || pos + a > data.size()) break;
+            doc.path = data.substr(pos, a); pos += a;
+            if (fromDisk) {
+                uint32_t lo, hi;
+                if (!GetU32(data, pos, a) || !GetU32(data, pos, lo) || !GetU32(data, pos, hi)) break;
+                doc.lines = ReadLinesFromDisk(doc.path);
+                if (doc.lines.size() != a || LineDiff::textHash(doc.lines) != ((uint64_t)hi << 32 | lo)) return -1;
+            } else doc.lines = std::vector<std::string>{""};
+            hasHeader = true;
+        } else if (type == 'S' && hasHeader) {
+            if (!GetU32(data, pos, a) || !GetU32(data, pos, b) || !GetU32(data, pos, c)) break;
+            std::vector<std::string> repl; repl.reserve(std::min<size_t>(c, data.size() / 4));
+            bool whole = true;
+            for (uint32_t i = 0; i < c; i++) {
+                uint32_t len;
+                if (!GetU32(data, pos, len) || pos + len > data.size()) { whole = false; break; }
+                repl.push_back(data.substr(pos, len)); pos += len;
+            }
+            if (!whole) break;
+            if ((uint64_t)a + b > doc.lines.size()) return -1;
+            doc.lines.erase(doc.lines.begin() + a, doc.lines.begin() + a + b);
+            doc.lines.insert(doc.lines.begin() + a, repl.begin(), repl.end());
+            if (doc.lines.empty()) doc.lines.push_back("");
+            applied++;
+        } else if (type == 'P' && hasHeader) {
+            uint32_t headLen, tailLen, lo, hi;
+            if (!GetU32(data, pos, a) || !GetU32(data, pos, b) || !GetU32(data, pos, headLen) || pos + headLen > data.size()) break;
+            std::string_view head(data.data() + pos, headLen); pos += headLen;
+            if (!GetU32(data, pos, tailLen) || pos + tailLen > data.size()) break;
+            std::string_view tail(data.data() + pos, tailLen); pos += tailLen;
+            if (!GetU32(data, pos, lo) || !GetU32(data, pos, hi)) break;
+            uint64_t len = (uint64_t)hi << 32 | lo;
+            if (len > data.size() - pos) break;
+            if ((uint64_t)a + b > doc.lines.size()) return -1;
+            std::vector<std::string> repl;
+            ForEachLine(head, std::string_view(data.data() + pos, len), tail, [&](const std::string& l) { repl.push_back(l); });
+            pos += len;
+            doc.lines.erase(doc.lines.begin() + a, doc.lines.begin() + a + b);
+            doc.lines.insert(doc.lines.begin() + a, std::make_move_iterator(repl.begin()), std::make_move_iterator(repl.end()));
+            applied++;
+        } else if (type == 'B' && hasHeader) {
+            uint32_t len;
+            if (!GetU32(data, pos, a) || !GetU32(data, pos, b) || !GetU32(data, pos, c) || !GetU32(data, pos, len) || pos + len > data.size()) break;
+            if (a >= doc.lines.size() || (uint64_t)b + c > doc.lines[a].size()) return -1;
+            std::string& line = doc.lines[a];
+            line.replace(b, line.size() - c - b, data, pos, len); pos += len;
+            applied++;
+        } else return -1;
+    }
+    return applied;
+}
+
+Journal::~Journal() {
+    stop();
+    for (auto& [path, f] : adopted) fclose(f);
+}
+
+std::string Journal::fileFor(int docId) const {
+    return dir + "/" + session + "-" + std::to_string(docId) + ".jnl";
+}
+
+// Replays every journal left behind by an instance that is no longer running.
+// Journals of running instances are locked and skipped. A replayed journal
+// stays on disk, locked, until retire() is called for it; one that doesn't
+// match its file is unlocked and left for the user.
+std::vector<RecoveredDoc> Journal::recover(const std::string& journalDir, std::vector<std::string>& kept) {
+    std::vector<RecoveredDoc> result;
+    std::error_code ec;
+    if (!fs::exists(journalDir, ec)) return result;
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(journalDir, ec)) {
+        const fs::path& p = entry.path();
+        if (p.extension() == ".jnl") files.push_back(p);
+        else if (p.extension() == ".tmp") { FILE* f = TryLock(p.string()); if (f) RemoveHeld(f, p.string()); }
+    }
+    std::sort(files.begin(), files.end());
+
+    for (const auto& file : files) {
+        std::string path = file.string();
+        FILE* f = TryLock(path);
+        if (!f) continue;
+        std::string data;
+        char buf[1 << 16];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+
+        RecoveredDoc doc;
+        doc.journal = path;
+        int applied = Replay(data, doc);
+        if (applied < 0) { fclose(f); kept.push_back(path); }
+        else if (applied == 0) RemoveHeld(f, path);
+        else { adopted[path] = f; result.push_back(std::move(doc)); }
+    }
+    return result;
+}
+
+void Journal::start(const std::string& journalDir) {
+    if (running) return;
+    dir = journalDir;
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    session = NewSession();
+    running = true;
+    writer = std::thread(&Journal::writerLoop, this);
+}
+
+void Journal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) return;
+        running = false;
+    }
+    cv.notify_one();
+    if (writer.joinable()) writer.join();
+}
+
+void Journal::push(Op op) {
+    std::lock_guard<std::mutex> lock(mtx);
+    pending.push_back(std::move(op));
+}
+
+void Journal::open(int docId, const std::string& path, bool fromDisk, uint32_t baseLines, uint64_t baseHash) { push({'O', docId, fromDisk, path, baseLines, baseHash}); }
+void Journal::saved(int docId, const std::string& path, uint32_t baseLines, uint64_t baseHash) { push({'V', docId, true, path, baseLines, baseHash}); }
+void Journal::close(int docId) { push({'C', docId, false, ""}); }
+void Journal::retire(const std::string& journalFile) { push({'R', 0, false, journalFile}); }
+
+// Replace lines [first, first+oldCount) of the journaled text with lines[first, first+newCount).
+void Journal::append(int docId, int first, int oldCount, const std::vector<std::string>& lines, int newCount, std::shared_ptr<const PastedText> pasted) {
+    Op op{'S', docId, false, ""};
+    if (pasted) {
+        // The writer appends the paste itself; nothing is copied here.
+        op.data += 'P';
+        PutU32(op.data, first); PutU32(op.data, oldCount);
+        op.pasted = std::move(pasted);
+        push(std::move(op));
+        return;
+    }
+    size_t bytes = 13;
+    for (int i = 0; i < newCount; i++) bytes += 4 + lines[first + i].size();
+    op.data.reserve(bytes);
+    op.data += 'S';
+    PutU32(op.data, first); PutU32(op.data, oldCount); PutU32(op.data, newCount);
+    for (int i = 0; i < newCount; i++) { const std::string& l = lines[first + i]; PutU32(op.data, (uint32_t)l.size()); op.data += l; }
+    push(std::move(op));
+}
+
+// Replace bytes [fromCol, size - keepTail) of line row with the same bytes of line.
+void Journal::appendBytes(int docId, int row, int fromCol, int keepTail, const std::string& line) {
+    Op op{'S', docId, false, ""};
+    size_t len = line.size() - keepTail - fromCol;
+    op.data.reserve(17 + len);
+    op.data += 'B';
+    PutU32(op.data, row); PutU32(op.data, fromCol); PutU32(op.data, keepTail); PutU32(op.data, (uint32_t)len);
+    op.data.append(line, fromCol, len);
+    push(std::move(op));
+}
+
+void Journal::process(Op& op) {
+    if (op.type == 'O') {
+        DocLog& log = logs[op.docId];
+        log.path = op.data; log.fromDisk = op.fromDisk;
+        log.baseLines = op.baseLines; log.baseHash = op.baseHash;
+    } else if (op.type == 'S') {
+        DocLog& log = logs[op.docId];
+        if (!log.file) {
+            log.file = CreateLocked(fileFor(op.docId));
+            if (!log.file) return;
+            std::string header = "H"; header += (char)(log.fromDisk ? 1 : 0);
+            PutU32(header, (uint32_t)log.path.size()); header += log.path;
+            if (log.fromDisk) { PutU32(header, log.baseLines); PutU32(header, (uint32_t)log.baseHash); PutU32(header, (uint32_t)(log.baseHash >> 32)); }
+            fwrite(header.data(), 1, header.size(), log.file);
+        }
+        fwrite(op.data.data(), 1, op.data.size(), log.file);
+        if (op.pasted) {
+            const PastedText& p = *op.pasted;
+            std::string rest;
+            PutU32(rest, (uint32_t)p.head.size()); rest += p.head;
+            PutU32(rest, (uint32_t)p.tail.size()); rest += p.tail;
+            PutU32(rest, (uint32_t)p.body.size()); PutU32(rest, (uint32_t)((uint64_t)p.body.size() >> 32));
+            fwrite(rest.data(), 1, rest.size(), log.file);
+            fwrite(p.body.data(), 1, p.body.size(), log.file);
+        }
+        log.needsSync = true;
+    } else if (op.type == 'V' || op.type == 'C') {
+        // The text now matches the file on disk (or is discarded), so the log compacts to nothing.
+        auto it = logs.find(op.docId);
+        if (it == logs.end()) return;
+        if (it->second.file) { RemoveHeld(it->second.file, fileFor(op.docId)); it->second.file = nullptr; }
+        if (op.type == 'C') logs.erase(it);
+        else { it->second.path = op.data; it->second.fromDisk = true; it->second.baseLines = op.baseLines; it->second.baseHash = op.baseHash; it->second.needsSync = false; }
+    } else if (op.type == 'R') {
+        // The recovered text was journaled again by the ops before this one; make that durable first.
+        auto it = adopted.find(op.data);
+        if (it == adopted.end()) return;
+        syncAll();
+        RemoveHeld(it->second, it->first);
+        adopted.erase(it);
+    }
+}
+
+void Journal::syncAll() {
+    for (auto& [id, log] : logs) {
+        if (log.file && log.needsSync) { fflush(log.file); JOURNAL_FSYNC(log.file); log.needsSync = false; }
+    }
+}
+
+void Journal::writerLoop() {
+    auto lastSync = std::chrono::steady_clock::now();
+    std::vector<Op> batch;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait_for(lock, std::chrono::duration<float>(commitInterval), [this] { return !running; });
+        bool exiting = !running;
+        batch.swap(pending);
+        lock.unlock();
+
+        for (Op& op : batch) process(op);
+        if (!batch.empty()) for (auto& [id, log] : logs) if (log.file) fflush(log.file);
+        batch.clear();
+
+        auto now = std::chrono::steady_clock::now();
+        if (exiting || std::chrono::duration<float>(now - lastSync).count() >= syncInterval) { syncAll(); lastSync = now; }
+        if (exiting) break;
+        lock.lock();
+    }
+    for (auto& [id, log] : logs) if (log.file) { fclose(log.file); log.file = nullptr; }
+}
@@ -0,0 +1,313 @@
+#include "../include/LineDiff.hpp"
+#include "../include/JobSystem.hpp"
+#include <cstring>
+
+uint64_t LineDiff::hashLine(const std::string& s) {
+    const char* p = s.data();
+    size_t n = s.size(), i = 0;
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    uint64_t w = 0;
+    memcpy(&w, p + i, n - i);
+    h = (h ^ w) * 0xC4CEB9FE1A85EC53ull;
+    return h ^ (h >> 29);
+}
+
+uint64_t LineDiff::hashAll(const std::vector<uint64_t>& hashes) {
+    uint64_t h = hashes.size();
+    for (uint64_t x : hashes) {
+        h = (h ^ x) * 0x100000001B3ull;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+uint64_t LineDiff::textHash(const std::vector<std::string>& lines) {
+    std::vector<uint64_t> hashes(lines.size());
+    for (size_t i = 0; i < lines.size(); i++) hashes[i] = hashLine(lines[i]);
+    return hashAll(hashes);
+}
+
+void LineDiff::reset(const std::vector<std::string>& lines) {
+    cur.resize(lines.size());
+    for (size_t i = 0; i < lines.size(); i++) cur[i] = hashLine(lines[i]);
+    base = cur;
+    baseHash = hashAll(base);
+    hasBase = true;
+    clean = true;
+    hunks.clear();
+    dirty.clear();
+    job.reset();
+    superseded.reset();
+    jobStale = false;
+    hashing.reset();
+    hashSuperseded.reset();
+}
+
+// Where [from, to) of the old buffer ends up after lines [first, first+oldCount)
+// were replaced by newCount lines. Bounds inside the replaced block collapse onto it.
+void LineDiff::mapRange(int& from, int& to, int first, int oldCount, int newCount) {
+    int oldEnd = first + oldCount, delta = newCount - oldCount;
+    from = from < first ? from : (from >= oldEnd ? from + delta : first);
+    to = to <= first ? to : (to >= oldEnd ? to + delta : first + newCount);
+}
+
+// Ranges stay separate unless they overlap, so edits far apart are diffed as small windows.
+void LineDiff::markDirty(int from, int to) {
+    for (auto it = dirty.begin(); it != dirty.end();) {
+        if (it->first <= to && it->second >= from) {
+            from = std::min(from, it->first);
+            to = std::max(to, it->second);
+            it = dirty.erase(it);
+        } else ++it;
+    }
+    dirty.push_back({from, to});
+}
+
+// Replace lines [first, first+oldCount) of the tracked text with lines[first, first+newCount).
+void LineDiff::splice(int first, int oldCount, const std::vector<std::string>& lines, int newCount, std::shared_ptr<const PastedText> pasted) {
+    if (!hasBase) return;
+    first = std::min(first, (int)cur.size());
+    oldCount = std::min(oldCount, (int)cur.size() - first);
+    int oldEnd = first + oldCount, delta = newCount - oldCount;
+    if (oldCount != newCount) {
+        cur.erase(cur.begin() + first, cur.begin() + oldEnd);
+        cur.insert(cur.begin() + first, newCount, 0);
+    }
+    if (!pasted) for (int i = 0; i < newCount; i++) cur[first + i] = hashLine(lines[first + i]);
+
+    // Keep the hunks a valid alignment until the worker refines it: the edit
+    // and every hunk it touches collapse into one provisional hunk, later ones shift.
+    int cFrom = first, cTo = oldEnd, shift = 0, inside = 0;
+    std::vector<DiffHunk> kept;
+    kept.reserve(hunks.size() + 1);
+    for (const DiffHunk& h : hunks) {
+        int hEnd = h.curStart + h.curCount;
+        if (hEnd < first) { shift += h.baseCount - h.curCount; kept.push_back(h); continue; }
+        if (h.curStart > oldEnd) continue;
+        cFrom = std::min(cFrom, h.curStart);
+        cTo = std::max(cTo, hEnd);
+        inside += h.baseCount - h.curCount;
+    }
+    DiffHunk merged{cFrom + shift, cTo - cFrom + inside, cFrom, cTo - cFrom + delta};
+    if (merged.baseCount > 0 || merged.curCount > 0) kept.push_back(merged);
+    for (const DiffHunk& h : hunks) {
+        if (h.curStart <= oldEnd) continue;
+        kept.push_back(h);
+        kept.back().curStart += delta;
+    }
+    hunks.swap(kept);
+    for (auto& r : dirty) mapRange(r.first, r.second, first, oldCount, newCount);
+    // A result computed for the old text can't be spliced in; fold its windows back into the dirty ranges.
+    if (job && !jobStale) {
+        for (Window& w : job->windows) {
+            mapRange(w.curFrom, w.curTo, first, oldCount, newCount);
+            markDirty(w.curFrom, w.curTo);
+        }
+        jobStale = true;
+    }
+    // Pasted lines still being hashed move with the edit, unless it reaches
+    // into them or another paste comes in; then they are hashed here.
+    if (hashing) {
+        int from = hashing->first, to = from + hashing->count;
+        bool overlaps = from < oldEnd && to > first;
+        mapRange(from, to, first, oldCount, newCount);
+        hashing->first = from; hashing->count = to - from;
+        if (overlaps || pasted) hashNow(lines);
+    }
+    if (pasted) startHashing(first, std::move(pasted));
+    else markDirty(first, first + newCount);
+    clean = false;
+}
+
+void LineDiff::startHashing(int first, std::shared_ptr<const PastedText> pasted) {
+    std::shared_ptr<Hashing> h = std::make_shared<Hashing>();
+    h->first = first;
+    h->count = pasted->lineCount;
+    hashing = h;
+    JobSystem::instance().submit("diff.hash", JobPriority::Interactive, [h, pasted, n = h->count]() {
+        h->hashes.reserve(n);
+        ForEachLine(pasted->head, pasted->body, pasted->tail, [&](const std::string& line) { h->hashes.push_back(hashLine(line)); });
+        h->done = true;
+    }, hashSuperseded.token());
+}
+
+// Gives up on the worker and hashes the pending lines from the buffer.
+void LineDiff::hashNow(const std::vector<std::string>& lines) {
+    for (int i = hashing->first; i < hashing->first + hashing->count; i++) cur[i] = hashLine(lines[i]);
+    markDirty(hashing->first, hashing->first + hashing->count);
+    hashing.reset();
+    hashSuperseded.reset();
+}
+
+// Only a clean diff can follow the saved text along; anything else starts over.
+void LineDiff::rebase(int first, int oldCount, const std::vector<std::string>& lines, int newCount) {
+    if (!hasBase) return;
+    if (!clean || job || hashing || !dirty.empty()) { reset(lines); return; }
+    first = std::min(first, (int)cur.size());
+    oldCount = std::min(oldCount, (int)cur.size() - first);
+    cur.erase(cur.begin() + first, cur.begin() + first + oldCount);
+    cur.insert(cur.begin() + first, newCount, 0);
+    for (int i = 0; i < newCount; i++) cur[first + i] = hashLine(lines[first + i]);
+    base = cur;
+    baseHash = hashAll(base);
+}
+
+// Myers over line hashes with the common prefix and suffix trimmed first.
+// Past MAX_EDIT_DISTANCE the middle is reported as a single hunk.
+void LineDiff::run(Window& w) {
+    const std::vector<uint64_t>& a = w.base;
+    const std::vector<uint64_t>& b = w.cur;
+    int lo = 0, an = (int)a.size(), bn = (int)b.size();
+    while (lo < an && lo < bn && a[lo] == b[lo]) lo++;
+    while (an > lo && bn > lo && a[an - 1] == b[bn - 1]) { an--; bn--; }
+    int n = an - lo, m = bn - lo;
+    if (n == 0 && m == 0) return;
+    if (n == 0 || m == 0) {
+        w.hunks.push_back({lo, n, lo, m});
+        return;
+    }
+
+    const int maxD = std::min(n + m, MAX_EDIT_DISTANCE);
+    const int off = maxD + 1;
+    std::vector<int> v(2 * maxD + 3, 0);
+    std::vector<int> trace;          // v[-d..d] as it was before round d
+    std::vector<size_t> traceAt;
+    int found = -1;
+    for (int d = 0; d <= maxD && found < 0; d++) {
+        traceAt.push_back(trace.size());
+        trace.insert(trace.end(), v.begin() + off - d, v.begin() + off + d + 1);
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v[off + k - 1] < v[off + k + 1])) ? v[off + k + 1] : v[off + k - 1] + 1;
+            int y = x - k;
+            while (x < n && y < m && a[lo + x] == b[lo + y]) { x++; y++; }
+            v[off + k] = x;
+            if (x >= n && y >= m) { found = d; break; }
+        }
+    }
+    if (found < 0) {
+        w.hunks.push_back({lo, n, lo, m});
+        return;
+    }
+
+    // Walk back to collect single-line moves: (x, y, deleted?) in reverse order.
+    struct Move { int x, y; bool del; };
+    std::vector<Move> moves;
+    int x = n, y = m;
+    for (int d = found; d > 0; d--) {
+        const int* pv = trace.data() + traceAt[d] + d;     // pv[k] for k in [-d, d]
+        int k = x - y;
+        int pk = (k == -d || (k != d && pv[k - 1] < pv[k + 1])) ? k + 1 : k - 1;
+        int px = pv[pk], py = px - pk;
+        while (x > px && y > py) { x--; y--; }
+        moves.push_back({px, py, x > px});
+        x = px;
+        y = py;
+    }
+    for (auto it = moves.rbegin(); it != moves.rend(); ++it) {
+        int bx = lo + it->x, cy = lo + it->y;
+        if (w.hunks.empty() || w.hunks.back().baseStart + w.hunks.back().baseCount != bx || w.hunks.back().curStart + w.hunks.back().curCount != cy) w.hunks.push_back({bx, 0, cy, 0});
+        if (it->del) w.hunks.back().baseCount++;
+        else w.hunks.back().curCount++;
+    }
+}
+
+void LineDiff::startJob() {
+    int n = (int)cur.size();
+    std::shared_ptr<Job> j = std::make_shared<Job>();
+    std::sort(dirty.begin(), dirty.end());
+    for (const auto& r : dirty) {
+        int from = std::max(0, r.first - CONTEXT), to = std::min(n, r.second + CONTEXT);
+        if (!j->windows.empty() && j->windows.back().curTo >= from) {
+            j->windows.back().curTo = std::max(j->windows.back().curTo, to);
+            continue;
+        }
+        j->windows.push_back({from, to, 0, {}, {}, {}});
+    }
+    // Widen to every hunk a window touches; those get recomputed whole.
+    // Widened windows can meet, so repeat until stable.
+    for (bool grew = true; grew;) {
+        grew = false;
+        for (Window& w : j->windows) {
+            for (const DiffHunk& h : hunks) {
+                if (h.curStart <= w.curTo && h.curStart + h.curCount >= w.curFrom && (h.curStart < w.curFrom || h.curStart + h.curCount > w.curTo)) {
+                    w.curFrom = std::min(w.curFrom, h.curStart);
+                    w.curTo = std::max(w.curTo, h.curStart + h.curCount);
+                    grew = true;
+                }
+            }
+        }
+        for (size_t i = 1; i < j->windows.size(); i++) {
+            if (j->windows[i - 1].curTo >= j->windows[i].curFrom) {
+                j->windows[i - 1].curFrom = std::min(j->windows[i - 1].curFrom, j->windows[i].curFrom);
+                j->windows[i - 1].curTo = std::max(j->windows[i - 1].curTo, j->windows[i].curTo);
+                j->windows.erase(j->windows.begin() + i--);
+                grew = true;
+            }
+        }
+    }
+    dirty.clear();
+
+    for (Window& w : j->windows) {
+        int before = 0, inside = 0;
+        for (const DiffHunk& h : hunks) {
+            if (h.curStart + h.curCount < w.curFrom) before += h.baseCount - h.curCount;
+            else if (h.curStart <= w.curTo) inside += h.baseCount - h.curCount;
+        }
+        int bFrom = Clamp(w.curFrom + before, 0, (int)base.size());
+        int bTo = Clamp(w.curTo + before + inside, bFrom, (int)base.size());
+        w.baseFrom = bFrom;
+        w.base.assign(base.begin() + bFrom, base.begin() + bTo);
+        w.cur.assign(cur.begin() + w.curFrom, cur.begin() + w.curTo);
+    }
+    job = j;
+    jobStale = false;
+    JobSystem::instance().submit("diff.windows", JobPriority::Interactive, [j]() {
+        for (Window& w : j->windows) run(w);
+        j->done = true;
+    }, superseded.token());
+}
+
+bool LineDiff::poll() {
+    if (!hasBase) return false;
+    bool landed = false;
+    if (hashing && hashing->done) {
+        std::copy(hashing->hashes.begin(), hashing->hashes.end(), cur.begin() + hashing->first);
+        markDirty(hashing->first, hashing->first + hashing->count);
+        hashing.reset();
+    }
+    if (job && job->done) {
+        std::shared_ptr<Job> j = job;
+        job.reset();
+        if (!jobStale) {
+            for (Window& w : j->windows) {
+                hunks.erase(std::remove_if(hunks.begin(), hunks.end(), [&w](const DiffHunk& h) { return h.curStart <= w.curTo && h.curStart + h.curCount >= w.curFrom; }), hunks.end());
+                for (DiffHunk h : w.hunks) {
+                    h.baseStart += w.baseFrom;
+                    h.curStart += w.curFrom;
+                    hunks.push_back(h);
+                }
+            }
+            std::sort(hunks.begin(), hunks.end(), [](const DiffHunk& a, const DiffHunk& b) { return a.curStart < b.curStart; });
+            landed = true;
+        }
+    }
+    if (!job && !hashing && !dirty.empty()) startJob();
+    // No hunks only means the line hashes agree; confirm against the saved content hash.
+    if (landed && !job && !hashing) clean = hunks.empty() && cur.size() == base.size() && hashAll(cur) == baseHash;
+    return landed;
+}
+
+LineChange LineDiff::changeAt(int line) const {
+    auto it = std::upper_bound(hunks.begin(), hunks.end(), line, [](int l, const DiffHunk& h) { return l < h.curStart; });
+    if (it == hunks.begin()) return LineChange::None;
+    const DiffHunk& h = *(it - 1);
+    if (h.curCount == 0) return h.curStart == line ? LineChange::DeletedAbove : LineChange::None;
+    if (line >= h.curStart + h.curCount) return LineChange::None;
+    return h.baseCount == 0 ? LineChange::Added : LineChange::Modified;
+}
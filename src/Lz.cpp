@@ -0,0 +1,83 @@
+#include "../include/Lz.hpp"
+#include <cstring>
+
+static constexpr int HASH_BITS = 14;
+static constexpr size_t MIN_MATCH = 4;
+static constexpr size_t MAX_OFFSET = 65535;
+static constexpr size_t NO_POS = (size_t)-1;
+
+static void PutLength(std::string& out, size_t v) {
+    while (v >= 255) { out += (char)255; v -= 255; }
+    out += (char)v;
+}
+
+static bool GetLength(const unsigned char* in, size_t size, size_t& pos, size_t& v) {
+    unsigned char b;
+    do {
+        if (pos >= size) return false;
+        b = in[pos++];
+        v += b;
+    } while (b == 255);
+    return true;
+}
+
+// One sequence: token (literal count << 4 | match length - 4), literals,
+// then a 16-bit offset unless this is the final literal-only sequence.
+static void PutSequence(std::string& out, const char* lit, size_t litLen, size_t offset, size_t matchLen) {
+    size_t m = matchLen ? matchLen - MIN_MATCH : 0;
+    out += (char)(((litLen < 15 ? litLen : 15) << 4) | (m < 15 ? m : 15));
+    if (litLen >= 15) PutLength(out, litLen - 15);
+    out.append(lit, litLen);
+    if (!matchLen) return;
+    out += (char)(offset & 0xFF);
+    out += (char)(offset >> 8);
+    if (m >= 15) PutLength(out, m - 15);
+}
+
+std::string LzCompress(const char* data, size_t len) {
+    std::string out;
+    out.reserve(len / 2 + 16);
+    std::vector<size_t> table((size_t)1 << HASH_BITS, NO_POS);
+    size_t anchor = 0, i = 0;
+    while (i + MIN_MATCH <= len) {
+        uint32_t seq;
+        memcpy(&seq, data + i, 4);
+        uint32_t h = (seq * 2654435761u) >> (32 - HASH_BITS);
+        size_t cand = table[h];
+        table[h] = i;
+        if (cand != NO_POS && i - cand <= MAX_OFFSET && memcmp(data + cand, data + i, MIN_MATCH) == 0) {
+            size_t m = MIN_MATCH;
+            while (i + m < len && data[cand + m] == data[i + m]) m++;
+            PutSequence(out, data + anchor, i - anchor, i - cand, m);
+            i += m;
+            anchor = i;
+        } else i++;
+    }
+    PutSequence(out, data + anchor, len - anchor, 0, 0);
+    return out;
+}
+
+bool LzDecompress(const std::string& in, std::string& out, size_t rawLen) {
+    out.resize(rawLen);
+    const unsigned char* src = (const unsigned char*)in.data();
+    size_t size = in.size(), ip = 0, op = 0;
+    while (ip < size) {
+        unsigned char token = src[ip++];
+        size_t lit = token >> 4;
+        if (lit == 15 && !GetLength(src, size, ip, lit)) return false;
+        if (ip + lit > size || op + lit > rawLen) return false;
+        memcpy(&out[op], src + ip, lit);
+        ip += lit; op += lit;
+        if (ip == size) break;
+        if (ip + 2 > size) return false;
+        size_t offset = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+        size_t m = token & 15;
+        if (m == 15 && !GetLength(src, size, ip, m)) return false;
+        m += MIN_MATCH;
+        if (offset == 0 || offset > op || op + m > rawLen) return false;
+        if (offset >= m) { memcpy(&out[op], &out[op - offset], m); op += m; }
+        else for (size_t k = 0; k < m; k++, op++) out[op] = out[op - offset];
+    }
+    return op == rawLen;
+}
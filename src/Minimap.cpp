@@ -0,0 +1,189 @@
+#include "../include/Minimap.hpp"
+#include "../include/JobSystem.hpp"
+#include <array>
+#include <cstring>
+
+void Minimap::rasterRow(const std::string& text, const Highlighter& hl, const Color* palette, Color* out) {
+    std::fill(out, out + WIDTH, BLANK);
+    std::vector<TokenSpan> spans;
+    hl.tokenize(text, spans, WIDTH * COLS_PER_PIXEL);
+    for (const TokenSpan& s : spans) {
+        Color c = palette[(int)s.kind]; c.a = 200;
+        for (int i = s.start; i < s.end; i++) out[i / COLS_PER_PIXEL] = c;
+    }
+}
+
+std::string Minimap::sampleFor(const std::vector<std::string>& lines, int row) const {
+    size_t line = (size_t)row * bucket;
+    if (row >= rows || line >= lines.size()) return "";
+    return lines[line].substr(0, WIDTH * COLS_PER_PIXEL);
+}
+
+void Minimap::uploadRows(int from, int to) {
+    if (to > from) UpdateTextureRec(texture, {0, (float)from, (float)WIDTH, (float)(to - from)}, &pixels[(size_t)from * WIDTH]);
+}
+
+void Minimap::paintRow(const std::vector<std::string>& lines, int row, const Highlighter& hl) {
+    rasterRow(sampleFor(lines, row), hl, palette, &pixels[(size_t)row * WIDTH]);
+    sampled[row] = row * bucket;
+    uploadRows(row, row + 1);
+}
+
+void Minimap::cancelJob() {
+    if (!job) return;
+    superseded.reset();
+    job.reset(); jobFrom = jobTo = -1;
+    unpainted = true;
+}
+
+// Rows whose line was replaced need painting; rows after it keep their pixels
+// and follow their line. A pending tile job was cut for the old numbering, so
+// it is dropped once lines move; its rows that never landed are still unpainted.
+void Minimap::onEdit(int id, int first, int oldCount, int newCount) {
+    if (id != docId) return;
+    int delta = newCount - oldCount;
+    auto remap = [&](int& line) {
+        if (line < first) return;
+        if (line < first + oldCount) { line = -1; unpainted = true; }
+        else line += delta;
+    };
+    for (int r = 0; r < rows; r++) remap(sampled[r]);
+    if (delta != 0) { shifted = true; cancelJob(); }
+    else if (job) for (auto& t : job->tiles) for (int& line : t->lines) remap(line);
+}
+
+// Gives every row a line of its own bucket that some row already shows,
+// moving those pixels; only buckets left without one are painted again.
+// Sampled lines stay in increasing order through edits, so one pass pairs them.
+void Minimap::matchRows() {
+    shifted = false;
+    std::vector<int> before = sampled;
+    std::vector<Color> beforePixels;
+    int movedFrom = capacity, movedTo = 0, k = 0;
+    for (int r = 0; r < capacity; r++) {
+        int from = r * bucket, to = std::min(lineCount, from + bucket);
+        while (k < capacity && before[k] < from) k++;
+        if (r >= rows || k >= capacity || before[k] >= to) {
+            sampled[r] = -1;
+            unpainted |= r < rows;
+            continue;
+        }
+        sampled[r] = before[k];
+        if (k != r) {
+            if (beforePixels.empty()) beforePixels = pixels;
+            std::copy(&beforePixels[(size_t)k * WIDTH], &beforePixels[(size_t)(k + 1) * WIDTH], &pixels[(size_t)r * WIDTH]);
+            movedFrom = std::min(movedFrom, r); movedTo = r + 1;
+        }
+        k++;
+    }
+    uploadRows(movedFrom, movedTo);
+}
+
+void Minimap::paintMissing(const std::vector<std::string>& lines, std::shared_ptr<const Highlighter> hl) {
+    unpainted = false;
+    int count = 0, from = rows, to = 0;
+    for (int r = 0; r < rows; r++) {
+        if (sampled[r] >= 0 || (r >= jobFrom && r < jobTo)) continue;
+        count++; from = std::min(from, r); to = r + 1;
+    }
+    if (count == 0) return;
+    if (count <= SYNC_ROWS) {
+        for (int r = from; r < to; r++) if (sampled[r] < 0 && !(r >= jobFrom && r < jobTo)) paintRow(lines, r, *hl);
+    } else scheduleTiles(lines, from, to, hl);
+}
+
+void Minimap::scheduleTiles(const std::vector<std::string>& lines, int fromRow, int toRow, std::shared_ptr<const Highlighter> hl) {
+    // A superseded job's rows were never uploaded, so the new one has to cover them too.
+    if (job) { fromRow = std::min(fromRow, jobFrom); toRow = std::min(capacity, std::max(toRow, jobTo)); }
+    std::shared_ptr<Job> j = std::make_shared<Job>();
+    for (int start = fromRow; start < toRow; start += TILE_ROWS) {
+        std::unique_ptr<Tile> t = std::make_unique<Tile>();
+        t->firstRow = start;
+        int count = std::min(TILE_ROWS, toRow - start);
+        t->samples.reserve(count);
+        for (int r = start; r < start + count; r++) { t->lines.push_back(r * bucket); t->samples.push_back(sampleFor(lines, r)); }
+        j->tiles.push_back(std::move(t));
+    }
+    job = j; jobFrom = fromRow; jobTo = toRow;
+    superseded.reset();
+
+    std::array<Color, (int)TokenKind::Count> pal;
+    std::copy(palette, palette + (int)TokenKind::Count, pal.begin());
+    CancelToken token = superseded.token();
+    JobSystem::instance().submit("minimap.tiles", JobPriority::Interactive, [j, hl, pal, token]() {
+        for (auto& t : j->tiles) {
+            if (token.cancelled()) return;
+            t->pixels.resize(t->samples.size() * WIDTH);
+            for (size_t i = 0; i < t->samples.size(); i++) rasterRow(t->samples[i], *hl, pal.data(), &t->pixels[i * WIDTH]);
+            t->done = true;
+        }
+    }, token);
+}
+
+// Rows of a tile whose line was edited after the snapshot stay unpainted and are painted on the UI thread.
+void Minimap::pollJob() {
+    if (!job) return;
+    while (job->uploaded < job->tiles.size() && job->tiles[job->uploaded]->done) {
+        Tile& t = *job->tiles[job->uploaded++];
+        int count = std::min((int)t.samples.size(), capacity - t.firstRow);
+        std::copy(t.pixels.begin(), t.pixels.begin() + (size_t)count * WIDTH, &pixels[(size_t)t.firstRow * WIDTH]);
+        uploadRows(t.firstRow, t.firstRow + count);
+        for (int i = 0; i < count; i++) { sampled[t.firstRow + i] = t.lines[i]; unpainted |= t.lines[i] < 0; }
+        t.pixels = std::vector<Color>(); t.samples = std::vector<std::string>();
+    }
+    if (job->uploaded == job->tiles.size()) { job.reset(); jobFrom = -1; jobTo = -1; }
+}
+
+void Minimap::update(int id, const std::vector<std::string>& lines, int stripHeight, std::shared_ptr<const Highlighter> hl) {
+    stripHeight = std::max(1, stripHeight);
+    bool full = false;
+    if (capacity < stripHeight) {
+        if (texture.id > 0) UnloadTexture(texture);
+        capacity = ((stripHeight + TILE_ROWS - 1) / TILE_ROWS) * TILE_ROWS;
+        Image img = GenImageColor(WIDTH, capacity, BLANK);
+        texture = LoadTextureFromImage(img);
+        UnloadImage(img);
+        pixels.assign((size_t)capacity * WIDTH, BLANK);
+        sampled.assign(capacity, -1);
+        full = true;
+    }
+    Color current[(int)TokenKind::Count];
+    for (int k = 0; k < (int)TokenKind::Count; k++) current[k] = Highlighter::colorOf((TokenKind)k);
+    if (memcmp(current, palette, sizeof(palette)) != 0) { memcpy(palette, current, sizeof(palette)); full = true; }
+
+    int n = (int)lines.size();
+    int newBucket = std::max(1, (n + stripHeight - 1) / stripHeight);
+    if (id != docId) full = true;
+    int newRows = (n + newBucket - 1) / newBucket;
+    if (newBucket != bucket || newRows != rows) shifted = true;
+    docId = id; lineCount = n; bucket = newBucket; rows = newRows;
+
+    if (full) { cancelJob(); std::fill(sampled.begin(), sampled.end(), -1); shifted = false; unpainted = true; }
+    if (shifted) matchRows();
+    if (unpainted) paintMissing(lines, hl);
+    pollJob();
+}
+
+void Minimap::render(Rectangle strip, int topLine, int bottomLine) {
+    DrawRectangleRec(strip, theme.panelBg);
+    DrawLine((int)strip.x, (int)strip.y, (int)strip.x, (int)(strip.y + strip.height), theme.border);
+    if (texture.id == 0 || rows == 0) return;
+    float scale = pixelScale(strip.height);
+    DrawTexturePro(texture, {0, 0, (float)WIDTH, (float)rows}, {strip.x, strip.y, (float)WIDTH, rows * scale}, {0, 0}, 0.0f, WHITE);
+    float y0 = strip.y + (float)topLine / bucket * scale;
+    float y1 = strip.y + (float)bottomLine / bucket * scale;
+    Color view = theme.text; view.a = 30;
+    DrawRectangleRec({strip.x, y0, strip.width, std::max(4.0f, y1 - y0)}, view);
+}
+
+int Minimap::lineAt(Rectangle strip, float y) const {
+    int row = (int)((y - strip.y) / pixelScale(strip.height));
+    return Clamp(row * bucket, 0, std::max(0, lineCount - 1));
+}
+
+void Minimap::unload() {
+    if (texture.id > 0) UnloadTexture(texture);
+    texture = { 0 }; capacity = 0; docId = -1;
+    cancelJob();
+    pixels = std::vector<Color>(); sampled = std::vector<int>();
+}
@@ -1,6 +1,7 @@
 #ifdef _WIN32
 #include <windows.h>
 #include <shlobj.h>
+#include <psapi.h>
 #include <string>
 #include <iostream>
 #include <direct.h> 
@@ -63,10 +64,79 @@ std::string SaveWindowsFileDialog(const char* defaultName) {
     return ""; 
 }
 
+// Read-only view of a whole file; handle is the mapping object to close later.
+const char* MapFileReadOnly(const std::string& path, size_t& size, void*& handle) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER len;
+    if (!GetFileSizeEx(file, &len) || len.QuadPart == 0) { CloseHandle(file); return nullptr; }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return nullptr;
+    const char* data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) { CloseHandle(mapping); return nullptr; }
+    size = (size_t)len.QuadPart; handle = mapping;
+    return data;
+}
+
+void UnmapFile(const char* data, size_t size, void* handle) {
+    if (data) UnmapViewOfFile(data);
+    if (handle) CloseHandle((HANDLE)handle);
+}
+
+double ThreadCpuMs() {
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 10000.0;
+}
+
+size_t PeakResidentBytes() {
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+}
+
 #else
 // Linux placeholders
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/resource.h>
 std::string OpenWindowsFolderPicker() { return ""; }
 std::string OpenWindowsFilePicker(const char* d) { return ""; }
 std::string SaveWindowsFileDialog(const char* d) { return ""; }
+
+const char* MapFileReadOnly(const std::string& path, size_t& size, void*& handle) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return nullptr; }
+    void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return nullptr;
+    size = (size_t)st.st_size; handle = nullptr;
+    return (const char*)data;
+}
+
+void UnmapFile(const char* data, size_t size, void* handle) {
+    if (data) munmap((void*)data, size);
+}
+
+double ThreadCpuMs() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+size_t PeakResidentBytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return (size_t)usage.ru_maxrss * 1024;   // kilobytes on Linux
+}
 #endif
\ No newline at end of file
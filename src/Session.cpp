@@ -0,0 +1,290 @@
+#include "../include/Session.hpp"
+#include "../include/JobSystem.hpp"
+#include "rlgl.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+Session session;
+
+static std::string Escape(const char* s) {
+    std::string out;
+    for (; *s; s++) {
+        if (*s == '\\') out += "\\\\";
+        else if (*s == '\n') out += "\\n";
+        else if (*s == '\r') out += "\\r";
+        else if (*s == '\t') out += "\\t";
+        else out += *s;
+    }
+    return out;
+}
+
+static std::string Unescape(const std::string& s) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] != '\\' || i + 1 == s.size()) { out += s[i]; continue; }
+        char c = s[++i];
+        out += c == 'n' ? '\n' : c == 'r' ? '\r' : c == 't' ? '\t' : c;
+    }
+    return out;
+}
+
+bool Session::record(const std::string& path, const std::vector<std::string>& openFiles) {
+    out = fopen(path.c_str(), "w");
+    if (!out) return false;
+    name = fs::path(path).stem().string();
+    files = openFiles;
+    fprintf(out, "ctom-session 1\nsize %d %d\n", initial.width, initial.height);
+    for (const std::string& f : files) fprintf(out, "open %s\n", f.c_str());
+    current = Mode::Record;
+    prepare();
+    return true;
+}
+
+bool Session::replay(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    if (!std::getline(file, line) || line != "ctom-session 1") { TraceLog(LOG_ERROR, "SESSION: %s is not a session file", path.c_str()); return false; }
+    int lineNo = 1;
+    while (std::getline(file, line)) {
+        lineNo++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string op;
+        fields >> op;
+        Change c;
+        c.op = op[0];
+        bool ok = op.size() == 1 || op == "size" || op == "open";
+        if (op == "size") fields >> initial.width >> initial.height;
+        else if (op == "open") files.push_back(line.substr(5));
+        else if (op == "i") { int n = 0; fields >> n; frames.resize(frames.size() + std::max(0, n)); }
+        else if (op == "f") frames.emplace_back();
+        else if (frames.empty()) ok = false;
+        else if (op == "t") { std::string tag; fields >> tag; tags.emplace_back((long long)frames.size() - 1, tag); }
+        else if (op == "s") steadyFrom = (long long)frames.size() - 1;
+        else {
+            if (c.op == 'p' || c.op == 'c') fields >> c.a;
+            else if (c.op == 'k' || c.op == 'b' || c.op == 'r') fields >> c.a >> c.b;
+            else if (c.op == 'm') fields >> c.x >> c.y;
+            else if (c.op == 'w') fields >> c.x;
+            else if (c.op == 'v') c.text = Unescape(line.size() > 2 ? line.substr(2) : "");
+            else ok = false;
+            if ((c.op == 'p' || c.op == 'k') && (c.a <= 0 || c.a >= MAX_KEYS)) ok = false;
+            if (c.op == 'b' && (c.a < 0 || c.a >= MAX_BUTTONS)) ok = false;
+            if (c.op == 'r' && (c.a <= 0 || c.b <= 0)) ok = false;
+            frames.back().push_back(std::move(c));
+        }
+        if (!ok || fields.fail()) { TraceLog(LOG_ERROR, "SESSION: %s:%d: cannot read '%s'", path.c_str(), lineNo, line.c_str()); return false; }
+    }
+    name = fs::path(path).stem().string();
+    // Per-frame results are stored inside the frame, where growing a vector would count as its allocation.
+    cpuMs.reserve(frames.size());
+    allocations.reserve(frames.size());
+    current = Mode::Replay;
+    prepare();
+    return true;
+}
+
+void Session::prepare() {
+    std::error_code ec;
+    fs::remove_all(JOURNAL_DIR, ec);
+    in = prev = initial;
+    if (!hashPath.empty()) hashes = fopen(hashPath.c_str(), "w");
+}
+
+void Session::close() {
+    if (out) {
+        flushFrame();
+        if (idleFrames > 0) fprintf(out, "i %d\n", idleFrames);
+        fclose(out);
+        out = nullptr;
+    }
+    if (hashes) { fclose(hashes); hashes = nullptr; }
+}
+
+void Session::beginFrame() {
+    if (!active()) return;
+    // Results of last frame's jobs are then drained in this frame on every run.
+    JobSystem::instance().waitIdle();
+    if (current == Mode::Record) flushFrame();
+    frame++;
+    prev = in;
+    in.pressedKeys.clear();
+    in.chars.clear();
+    in.wheel = 0;
+    nextKey = nextChar = 0;
+    if (current == Mode::Record) capture();
+    else if (frame < (long long)frames.size()) apply(frames[frame]);
+    frameStart = ThreadCpuMs();
+}
+
+// Reads this frame's input from raylib and notes how it differs from the last.
+void Session::capture() {
+    char line[64];
+    auto emit = [&](const char* fmt, auto... args) { snprintf(line, sizeof(line), fmt, args...); block += line; };
+    for (int k = ::GetKeyPressed(); k > 0; k = ::GetKeyPressed()) if (k < MAX_KEYS) { in.pressedKeys.push_back(k); in.keys[k] = true; emit("p %d\n", k); }
+    for (int c = ::GetCharPressed(); c > 0; c = ::GetCharPressed()) { in.chars.push_back(c); emit("c %d\n", c); }
+    for (int k = 1; k < MAX_KEYS; k++) {
+        bool down = ::IsKeyDown(k);
+        if (down != in.keys[k]) { in.keys[k] = down; emit("k %d %d\n", k, (int)down); }
+    }
+    Vector2 mouse = ::GetMousePosition();
+    if (mouse.x != in.mouse.x || mouse.y != in.mouse.y) { in.mouse = mouse; emit("m %g %g\n", mouse.x, mouse.y); }
+    for (int b = 0; b < MAX_BUTTONS; b++) {
+        bool down = ::IsMouseButtonDown(b);
+        if (down != in.buttons[b]) { in.buttons[b] = down; emit("b %d %d\n", b, (int)down); }
+    }
+    in.wheel = ::GetMouseWheelMove();
+    if (in.wheel != 0) emit("w %g\n", in.wheel);
+    int w = ::GetScreenWidth(), h = ::GetScreenHeight();
+    if (w != in.width || h != in.height) { in.width = w; in.height = h; emit("r %d %d\n", w, h); }
+}
+
+// Writes the frame that just ran, folding runs of frames without changes.
+void Session::flushFrame() {
+    if (frame < 0) return;
+    if (block.empty()) { idleFrames++; return; }
+    if (idleFrames > 0) fprintf(out, "i %d\n", idleFrames);
+    fprintf(out, "f\n%s", block.c_str());
+    idleFrames = 0;
+    block.clear();
+}
+
+void Session::apply(const std::vector<Change>& changes) {
+    for (const Change& c : changes) {
+        switch (c.op) {
+            case 'p': in.keys[c.a] = true; in.pressedKeys.push_back(c.a); break;
+            case 'k': in.keys[c.a] = c.b != 0; break;
+            case 'c': in.chars.push_back(c.a); break;
+            case 'm': in.mouse = {c.x, c.y}; break;
+            case 'b': in.buttons[c.a] = c.b != 0; break;
+            case 'w': in.wheel += c.x; break;
+            case 'r': in.width = c.a; in.height = c.b; SetWindowSize(c.a, c.b); break;
+            case 'v': clipboard = c.text; break;
+        }
+    }
+}
+
+void Session::clipboardRead(const char* text) {
+    if (current != Mode::Record || !text || clipboard == text) return;
+    clipboard = text;
+    block += "v " + Escape(text) + "\n";
+}
+
+// Hashes the back buffer, so it has to run before EndDrawing() swaps it.
+void Session::endFrame() {
+    if (!active()) return;
+    cpuMs.push_back((float)(ThreadCpuMs() - frameStart));
+    if (!hashes) return;
+    rlDrawRenderBatchActive();
+    Image img = LoadImageFromScreen();
+    uint64_t h = 1469598103934665603ull;
+    const unsigned char* px = (const unsigned char*)img.data;
+    size_t bytes = (size_t)GetPixelDataSize(img.width, img.height, img.format);
+    for (size_t i = 0; i < bytes; i++) h = (h ^ px[i]) * 1099511628211ull;
+    fprintf(hashes, "%lld %016llx\n", frame, (unsigned long long)h);
+    UnloadImage(img);
+}
+
+void Session::frameAllocated(size_t n) {
+    if (current == Mode::Replay) allocations.push_back(n);
+}
+
+bool Session::report(const std::string& baselinePath) {
+    if (cpuMs.empty()) return true;
+    std::vector<float> sorted = cpuMs;
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](float q) { return sorted[std::min(sorted.size() - 1, (size_t)(q * sorted.size()))]; };
+    float p95 = at(0.95f);
+    float rssMB = PeakResidentBytes() / (1024.0f * 1024.0f);
+    printf("%s: %zu frames, CPU per frame p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms, peak RSS %.1f MB\n",
+           name.c_str(), sorted.size(), at(0.50f), p95, at(0.99f), sorted.back(), rssMB);
+    for (const auto& [frameNo, tag] : tags) {
+        if (frameNo < (long long)cpuMs.size()) printf("%s: %s %.2f ms\n", name.c_str(), tag.c_str(), cpuMs[frameNo]);
+    }
+    bool allocOk = true;
+    if (maxFrameAllocs >= 0) {
+        long long worst = -1, over = 0;
+        for (long long i = steadyFrom; i < (long long)allocations.size(); i++) {
+            if ((long long)allocations[i] <= maxFrameAllocs) continue;
+            over++;
+            if (worst < 0 || allocations[i] > allocations[worst]) worst = i;
+        }
+        if (over > 0) printf("%s: REGRESSION: %lld steady frames made more than %lld heap allocations, frame %lld made %zu\n", name.c_str(), over, maxFrameAllocs, worst, allocations[worst]);
+        else printf("%s: no steady frame made more than %lld heap allocations\n", name.c_str(), maxFrameAllocs);
+        allocOk = over == 0;
+    }
+    if (baselinePath.empty()) return allocOk;
+
+    std::ifstream in(baselinePath);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string session;
+        float baseP95 = 0, baseRssMB = 0;
+        if (!(fields >> session >> baseP95 >> baseRssMB) || session != name) continue;
+        bool slower = p95 > baseP95 * REGRESSION_RATIO + REGRESSION_SLACK_MS;
+        bool larger = rssMB > baseRssMB * REGRESSION_RATIO;
+        if (slower) printf("%s: REGRESSION: p95 %.2f ms, baseline %.2f ms\n", name.c_str(), p95, baseP95);
+        if (larger) printf("%s: REGRESSION: peak RSS %.1f MB, baseline %.1f MB\n", name.c_str(), rssMB, baseRssMB);
+        return !slower && !larger && allocOk;
+    }
+    in.close();
+    std::ofstream outFile(baselinePath, std::ios::app);
+    outFile << name << " " << p95 << " " << rssMB << "\n";
+    printf("%s: no baseline yet, added to %s\n", name.c_str(), baselinePath.c_str());
+    return allocOk;
+}
+
+namespace Input {
+    bool IsKeyDown(int key) {
+        if (!session.active()) return ::IsKeyDown(key);
+        return key > 0 && key < Session::MAX_KEYS && session.in.keys[key];
+    }
+    bool IsKeyPressed(int key) {
+        if (!session.active()) return ::IsKeyPressed(key);
+        return key > 0 && key < Session::MAX_KEYS && session.in.keys[key] && !session.prev.keys[key];
+    }
+    int GetKeyPressed() {
+        if (!session.active()) return ::GetKeyPressed();
+        return session.nextKey < session.in.pressedKeys.size() ? session.in.pressedKeys[session.nextKey++] : 0;
+    }
+    int GetCharPressed() {
+        if (!session.active()) return ::GetCharPressed();
+        return session.nextChar < session.in.chars.size() ? session.in.chars[session.nextChar++] : 0;
+    }
+    bool IsMouseButtonDown(int button) {
+        if (!session.active()) return ::IsMouseButtonDown(button);
+        return button >= 0 && button < Session::MAX_BUTTONS && session.in.buttons[button];
+    }
+    bool IsMouseButtonPressed(int button) {
+        if (!session.active()) return ::IsMouseButtonPressed(button);
+        return button >= 0 && button < Session::MAX_BUTTONS && session.in.buttons[button] && !session.prev.buttons[button];
+    }
+    bool IsMouseButtonReleased(int button) {
+        if (!session.active()) return ::IsMouseButtonReleased(button);
+        return button >= 0 && button < Session::MAX_BUTTONS && !session.in.buttons[button] && session.prev.buttons[button];
+    }
+    Vector2 GetMousePosition() { return session.active() ? session.in.mouse : ::GetMousePosition(); }
+    float GetMouseWheelMove() { return session.active() ? session.in.wheel : ::GetMouseWheelMove(); }
+    double GetTime() { return session.active() ? std::max(0LL, session.frame) * (double)Session::TIMESTEP : ::GetTime(); }
+    float GetFrameTime() { return session.active() ? Session::TIMESTEP : ::GetFrameTime(); }
+    int GetScreenWidth() { return session.active() ? session.in.width : ::GetScreenWidth(); }
+    int GetScreenHeight() { return session.active() ? session.in.height : ::GetScreenHeight(); }
+
+    // A replay never touches the system clipboard: copies and pastes stay inside the session.
+    const char* GetClipboardText() {
+        if (session.mode() == Session::Mode::Replay) return session.clipboard.c_str();
+        const char* text = ::GetClipboardText();
+        session.clipboardRead(text);
+        return text;
+    }
+    void SetClipboardText(const char* text) {
+        if (session.mode() != Session::Mode::Replay) ::SetClipboardText(text);
+        if (session.active()) session.clipboard = text;
+    }
+    bool WindowShouldClose() { return ::WindowShouldClose() || session.finished(); }
+}
@@ -0,0 +1,342 @@
+#include "../include/SymbolIndex.hpp"
+#include "../include/Highlighter.hpp"
+#include <filesystem>
+#include <unordered_map>
+#include <string_view>
+#include "../include/JobSystem.hpp"
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+struct Tag {
+    std::string name;
+    uint32_t line;
+    char kind;
+};
+
+struct Token {
+    std::string text;
+    uint32_t line;
+};
+
+static bool IsIdentStart(unsigned char c) { return isalpha(c) || c == '_'; }
+static bool IsIdentChar(unsigned char c) { return isalnum(c) || c == '_'; }
+
+static bool IsCSource(const fs::path& p) {
+    static const char* exts[] = { ".c", ".h", ".cpp", ".hpp", ".cc", ".hh", ".cxx", ".hxx", ".inl" };
+    std::string ext = p.extension().string();
+    for (const char* e : exts) if (ext == e) return true;
+    return false;
+}
+
+static bool IsStatementKeyword(const std::string& t) {
+    static const char* words[] = { "if", "for", "while", "switch", "catch", "return", "sizeof", "do", "else", "new", "delete", "throw", "case", "decltype", "alignof", "static_assert" };
+    for (const char* w : words) if (t == w) return true;
+    return false;
+}
+
+// Decides what a '{' opens from the tokens since the previous ';', '{' or '}'.
+// Scopes: 'n' namespace-like (transparent), 'c' class body, 'b' any other block.
+static void OpenScope(const std::vector<Token>& stmt, std::vector<char>& scopes, std::vector<Tag>& out) {
+    if (std::find(scopes.begin(), scopes.end(), 'b') != scopes.end()) { scopes.push_back('b'); return; }
+
+    int angle = 0;
+    bool inTemplate = false;
+    for (size_t i = 0; i < stmt.size(); i++) {
+        const std::string& t = stmt[i].text;
+        if (t == "template") inTemplate = true;
+        else if (t == "<" && inTemplate) angle++;
+        else if (t == ">" && angle > 0) angle--;
+        else if (t == "(" || t == "=") break;
+        else if (angle == 0 && (t == "namespace" || t == "class" || t == "struct" || t == "union" || t == "enum")) {
+            size_t j = i + 1;
+            if (t == "enum" && j < stmt.size() && (stmt[j].text == "class" || stmt[j].text == "struct")) j++;
+            const Token* name = nullptr;
+            for (; j < stmt.size(); j++) {
+                const std::string& s = stmt[j].text;
+                if (s == ":" || s == "<") break;
+                if (IsIdentStart(s[0]) && s != "final") name = &stmt[j];
+            }
+            char kind = (t == "namespace") ? 'n' : (t == "enum") ? 'e' : t[0];
+            if (name) out.push_back({name->text, name->line, kind});
+            scopes.push_back(kind == 'n' ? 'n' : kind == 'e' ? 'b' : 'c');
+            return;
+        }
+    }
+
+    size_t paren = 0;
+    while (paren < stmt.size() && stmt[paren].text != "(") paren++;
+    if (paren == stmt.size()) { scopes.push_back(stmt.size() == 1 && stmt[0].text == "extern" ? 'n' : 'b'); return; }
+    for (size_t i = 0; i < paren; i++) {
+        if (stmt[i].text == "=" || IsStatementKeyword(stmt[i].text)) { scopes.push_back('b'); return; }
+    }
+    if (paren > 0 && IsIdentStart(stmt[paren - 1].text[0]) && stmt[paren - 1].text != "operator") {
+        std::string name = stmt[paren - 1].text;
+        if (paren > 1 && stmt[paren - 2].text == "~") name = "~" + name;
+        out.push_back({name, stmt[paren - 1].line, 'f'});
+    }
+    scopes.push_back('b');
+}
+
+// Definitions only: forward declarations and prototypes end in ';' and are skipped.
+static void ParseTags(std::istream& in, std::vector<Tag>& out) {
+    std::string line, code;
+    uint32_t lineNo = 0;
+    int state = Highlighter::LEX_CODE;
+    bool continued = false;
+    std::vector<Token> stmt;
+    std::vector<char> scopes;
+    while (std::getline(in, line)) {
+        lineNo++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t first = line.find_first_not_of(" \t");
+        if (continued || (state == Highlighter::LEX_CODE && first != std::string::npos && line[first] == '#')) {
+            if (!continued) {
+                size_t p = line.find_first_not_of(" \t", first + 1);
+                if (p != std::string::npos && line.compare(p, 6, "define") == 0) {
+                    p = line.find_first_not_of(" \t", p + 6);
+                    size_t e = p;
+                    while (e < line.size() && IsIdentChar(line[e])) e++;
+                    if (p != std::string::npos && e > p) out.push_back({line.substr(p, e - p), lineNo, 'd'});
+                }
+            }
+            continued = !line.empty() && line.back() == '\\';
+            continue;
+        }
+
+        code.assign(line.size(), ' ');
+        state = Highlighter::scanCode(line, state, [&](size_t i, char c) { code[i] = c; });
+        for (size_t i = 0; i < code.size();) {
+            unsigned char c = code[i];
+            if (isspace(c)) { i++; continue; }
+            if (IsIdentStart(c)) {
+                size_t s = i;
+                while (i < code.size() && IsIdentChar(code[i])) i++;
+                stmt.push_back({code.substr(s, i - s), lineNo});
+            } else if (isdigit(c)) {
+                while (i < code.size() && (IsIdentChar(code[i]) || code[i] == '.')) i++;
+            } else if (c == ':' && i + 1 < code.size() && code[i + 1] == ':') {
+                stmt.push_back({"::", lineNo}); i += 2;
+            } else {
+                if (c == '{') { OpenScope(stmt, scopes, out); stmt.clear(); }
+                else if (c == '}') { if (!scopes.empty()) scopes.pop_back(); stmt.clear(); }
+                else if (c == ';') stmt.clear();
+                else stmt.push_back({std::string(1, (char)c), lineNo});
+                i++;
+            }
+        }
+        if (stmt.size() > 512) stmt.erase(stmt.begin(), stmt.begin() + 256);
+    }
+}
+
+SymbolIndex::~SymbolIndex() { unmap(); }
+
+std::string SymbolIndex::normalize(const std::string& path) {
+    return fs::path(path).lexically_normal().generic_string();
+}
+
+void SymbolIndex::build(std::shared_ptr<Job> job) {
+    struct FileEntry {
+        std::string path;
+        int64_t mtime;
+        uint64_t size;
+        std::vector<Tag> tags;
+    };
+
+    // Tags of unchanged files are carried over from the previous index.
+    std::unordered_map<std::string, FileEntry> previous;
+    {
+        std::ifstream in(job->indexPath, std::ios::binary);
+        std::string old((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (valid(old.data(), old.size())) {
+            const Header* h = (const Header*)old.data();
+            const FileRec* fr = (const FileRec*)(old.data() + sizeof(Header));
+            const SymRec* sr = (const SymRec*)(fr + h->fileCount);
+            const uint32_t* order = (const uint32_t*)(sr + h->symbolCount);
+            const char* pool = (const char*)(order + h->symbolCount);
+            for (uint32_t f = 0; f < h->fileCount; f++) {
+                FileEntry e{std::string(pool + fr[f].pathOff, fr[f].pathLen), fr[f].mtime, fr[f].size, {}};
+                for (uint32_t k = fr[f].first; k < fr[f].first + fr[f].count; k++) {
+                    const SymRec& s = sr[order[k]];
+                    e.tags.push_back({std::string(pool + s.nameOff, s.nameLen), s.line, (char)s.kind});
+                }
+                previous[e.path] = std::move(e);
+            }
+        }
+    }
+
+    std::vector<FileEntry> files;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(job->root, fs::directory_options::skip_permission_denied, ec), end; it != end; it.increment(ec)) {
+        if (ec || job->cancel.cancelled()) break;
+        const fs::path& p = it->path();
+        if (it->is_directory(ec)) { if (p.filename().string().rfind('.', 0) == 0) it.disable_recursion_pending(); continue; }
+        if (!IsCSource(p)) continue;
+        FileEntry e{normalize(p.string()), (int64_t)it->last_write_time(ec).time_since_epoch().count(), (uint64_t)it->file_size(ec), {}};
+        auto old = previous.find(e.path);
+        if (old != previous.end() && old->second.mtime == e.mtime && old->second.size == e.size) {
+            e.tags = std::move(old->second.tags);
+            job->reused++;
+        } else {
+            std::ifstream in(p);
+            ParseTags(in, e.tags);
+            job->parsed++;
+        }
+        files.push_back(std::move(e));
+    }
+    if (job->cancel.cancelled()) return;
+    std::sort(files.begin(), files.end(), [](const FileEntry& a, const FileEntry& b) { return a.path < b.path; });
+
+    std::string pool;
+    std::vector<FileRec> fileRecs;
+    std::vector<SymRec> inFileOrder;
+    for (uint32_t f = 0; f < files.size(); f++) {
+        FileRec r{files[f].mtime, files[f].size, (uint32_t)pool.size(), (uint32_t)files[f].path.size(), (uint32_t)inFileOrder.size(), (uint32_t)files[f].tags.size()};
+        pool += files[f].path;
+        for (const Tag& t : files[f].tags) {
+            inFileOrder.push_back({(uint32_t)pool.size(), (uint32_t)t.name.size(), f, t.line, (uint32_t)t.kind});
+            pool += t.name;
+        }
+        fileRecs.push_back(r);
+    }
+    std::vector<uint32_t> order(inFileOrder.size());
+    for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    auto nameOf = [&](const SymRec& s) { return std::string_view(pool.data() + s.nameOff, s.nameLen); };
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return nameOf(inFileOrder[a]) < nameOf(inFileOrder[b]); });
+    std::vector<SymRec> byName(order.size());
+    std::vector<uint32_t> fileList(order.size());
+    for (uint32_t k = 0; k < order.size(); k++) { byName[k] = inFileOrder[order[k]]; fileList[order[k]] = k; }
+
+    Header h{{'C', 'T', 'S', 'Y'}, VERSION, (uint32_t)fileRecs.size(), (uint32_t)byName.size(), (uint32_t)pool.size(), {0, 0, 0}};
+    FILE* out = fopen(job->tmpPath.c_str(), "wb");
+    if (!out) { job->done = true; return; }
+    bool ok = fwrite(&h, sizeof(h), 1, out) == 1;
+    if (!fileRecs.empty()) ok = ok && fwrite(fileRecs.data(), sizeof(FileRec), fileRecs.size(), out) == fileRecs.size();
+    if (!byName.empty()) ok = ok && fwrite(byName.data(), sizeof(SymRec), byName.size(), out) == byName.size();
+    if (!fileList.empty()) ok = ok && fwrite(fileList.data(), 4, fileList.size(), out) == fileList.size();
+    if (!pool.empty()) ok = ok && fwrite(pool.data(), 1, pool.size(), out) == pool.size();
+    ok = (fclose(out) == 0) && ok;
+    job->ok = ok;
+    job->done = true;
+}
+
+// The index is read straight from the mapping, so every offset, count and
+// order entry in it is checked once here: a truncated or corrupt file must
+// not send a lookup outside the string pool or the record arrays.
+bool SymbolIndex::valid(const char* data, size_t size) {
+    if (size < sizeof(Header)) return false;
+    const Header* h = (const Header*)data;
+    if (memcmp(h->magic, "CTSY", 4) != 0 || h->version != VERSION) return false;
+    size_t need = sizeof(Header) + (size_t)h->fileCount * sizeof(FileRec) + (size_t)h->symbolCount * (sizeof(SymRec) + 4) + h->stringBytes;
+    if (need > size) return false;
+    const FileRec* fr = (const FileRec*)(data + sizeof(Header));
+    const SymRec* sr = (const SymRec*)(fr + h->fileCount);
+    const uint32_t* order = (const uint32_t*)(sr + h->symbolCount);
+    auto inPool = [h](uint32_t off, uint32_t len) { return (uint64_t)off + len <= h->stringBytes; };
+    for (uint32_t f = 0; f < h->fileCount; f++) {
+        if (!inPool(fr[f].pathOff, fr[f].pathLen) || (uint64_t)fr[f].first + fr[f].count > h->symbolCount) return false;
+    }
+    for (uint32_t k = 0; k < h->symbolCount; k++) {
+        if (!inPool(sr[k].nameOff, sr[k].nameLen) || sr[k].file >= h->fileCount || order[k] >= h->symbolCount) return false;
+    }
+    return true;
+}
+
+void SymbolIndex::map() {
+    unmap();
+    data = MapFileReadOnly(indexPath, size, handle);
+    if (data && !valid(data, size)) unmap();
+}
+
+void SymbolIndex::unmap() {
+    if (data) UnmapFile(data, size, handle);
+    data = nullptr; size = 0; handle = nullptr;
+}
+
+void SymbolIndex::startJob() {
+    if (job) { rescanQueued = true; return; }
+    job = std::make_shared<Job>();
+    job->root = root;
+    job->indexPath = indexPath;
+    job->tmpPath = indexPath + ".tmp";
+    job->cancel = scan.token();
+    std::shared_ptr<Job> j = job;
+    JobSystem::instance().submit("symbols.build", JobPriority::Background, [j]() { build(j); }, j->cancel);
+}
+
+void SymbolIndex::open(const std::string& folder) {
+    std::string r = normalize(folder);
+    if (r != root) {
+        close();
+        root = r;
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : root) { hash ^= c; hash *= 16777619u; }
+        char name[16];
+        snprintf(name, sizeof(name), "%08x", hash);
+        std::error_code ec;
+        fs::create_directories("data/symbols", ec);
+        indexPath = std::string("data/symbols/") + name + ".idx";
+        map();   // last session's index answers lookups until the rescan lands
+    }
+    startJob();
+}
+
+void SymbolIndex::close() {
+    unmap();
+    scan.reset();
+    job.reset();
+    root.clear();
+    rescanQueued = false;
+}
+
+void SymbolIndex::fileChanged(const std::string& path) {
+    if (root.empty()) return;
+    std::string p = normalize(path);
+    if (p.size() > root.size() && p.compare(0, root.size(), root) == 0 && IsCSource(p)) rescanQueued = true;
+}
+
+void SymbolIndex::update(float dt) {
+    if (root.empty()) return;
+    if (job && job->done) {
+        if (job->ok) {
+            // The mapping must go before the file can be replaced on Windows.
+            unmap();
+            std::error_code ec;
+            fs::rename(job->tmpPath, indexPath, ec);
+            map();
+            TraceLog(LOG_INFO, "SYMBOLS: %d files parsed, %d reused", job->parsed, job->reused);
+        }
+        job.reset();
+    }
+    rescanTimer += dt;
+    if (rescanTimer >= RESCAN_INTERVAL) { rescanTimer = 0.0f; rescanQueued = true; }
+    if (rescanQueued && !job) { rescanQueued = false; startJob(); }
+}
+
+SymbolHit SymbolIndex::hitFor(const SymRec& s) const {
+    const FileRec& f = files()[s.file];
+    return { std::string(strings() + s.nameOff, s.nameLen), std::string(strings() + f.pathOff, f.pathLen), (int)s.line, (char)s.kind };
+}
+
+void SymbolIndex::find(const std::string& name, std::vector<SymbolHit>& out) const {
+    out.clear();
+    if (!data) return;
+    const SymRec* begin = symbols();
+    const SymRec* end = begin + header()->symbolCount;
+    const char* pool = strings();
+    auto nameOf = [pool](const SymRec& s) { return std::string_view(pool + s.nameOff, s.nameLen); };
+    const SymRec* it = std::lower_bound(begin, end, name, [&](const SymRec& s, const std::string& n) { return nameOf(s) < n; });
+    for (; it != end && nameOf(*it) == name; ++it) out.push_back(hitFor(*it));
+}
+
+void SymbolIndex::outline(const std::string& path, std::vector<SymbolHit>& out) const {
+    out.clear();
+    if (!data) return;
+    std::string p = normalize(path);
+    const FileRec* begin = files();
+    const FileRec* end = begin + header()->fileCount;
+    const char* pool = strings();
+    const FileRec* it = std::lower_bound(begin, end, p, [pool](const FileRec& f, const std::string& n) { return std::string_view(pool + f.pathOff, f.pathLen) < n; });
+    if (it == end || std::string_view(pool + it->pathOff, it->pathLen) != p) return;
+    for (uint32_t k = it->first; k < it->first + it->count; k++) out.push_back(hitFor(symbols()[byFile()[k]]));
+}
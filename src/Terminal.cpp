@@ -22,6 +22,9 @@
 #endif
 
 #include "../include/Terminal.hpp"
+#include "../include/FrameArena.hpp"
+#include "../include/Session.hpp"
+#include "../include/TextBatch.hpp"
 
 #ifdef _WIN32
 #include <iostream>
@@ -103,12 +106,12 @@ void Terminal::runCommand(const std::string& cmd) { if (cmd == "clear" || cmd ==
 void Terminal::update(bool isFocused) {
     readFromPipe();
     if (!isFocused) return;
-    if (IsKeyPressed(KEY_UP)) { if (!cmdHistory.empty()) { if (historyIndex == -1) historyIndex = cmdHistory.size()-1; else if(historyIndex > 0) historyIndex--; inputBuffer = cmdHistory[historyIndex]; } }
-    if (IsKeyPressed(KEY_DOWN)) { if (historyIndex != -1) { if (historyIndex < (int)cmdHistory.size()-1) { historyIndex++; inputBuffer = cmdHistory[historyIndex]; } else { historyIndex = -1; inputBuffer = ""; } } }
-    int c = GetCharPressed();
-    while (c > 0) { if (c >= 32 && c <= 126) inputBuffer += (char)c; c = GetCharPressed(); }
-    if (IsKeyPressed(KEY_BACKSPACE) && !inputBuffer.empty()) inputBuffer.pop_back();
-    if (IsKeyPressed(KEY_ENTER)) { if (!inputBuffer.empty()) { runCommand(inputBuffer); inputBuffer = ""; historyIndex = -1; } else writeToPipe(""); }
+    if (Input::IsKeyPressed(KEY_UP)) { if (!cmdHistory.empty()) { if (historyIndex == -1) historyIndex = cmdHistory.size()-1; else if(historyIndex > 0) historyIndex--; inputBuffer = cmdHistory[historyIndex]; } }
+    if (Input::IsKeyPressed(KEY_DOWN)) { if (historyIndex != -1) { if (historyIndex < (int)cmdHistory.size()-1) { historyIndex++; inputBuffer = cmdHistory[historyIndex]; } else { historyIndex = -1; inputBuffer = ""; } } }
+    int c = Input::GetCharPressed();
+    while (c > 0) { if (c >= 32 && c <= 126) inputBuffer += (char)c; c = Input::GetCharPressed(); }
+    if (Input::IsKeyPressed(KEY_BACKSPACE) && !inputBuffer.empty()) inputBuffer.pop_back();
+    if (Input::IsKeyPressed(KEY_ENTER)) { if (!inputBuffer.empty()) { runCommand(inputBuffer); inputBuffer = ""; historyIndex = -1; } else writeToPipe(""); }
 }
 
 void Terminal::render(Rectangle bounds, Font font) {
@@ -128,10 +131,11 @@ void Terminal::render(Rectangle bounds, Font font) {
 
     BeginScissorMode((int)contentRect.x, (int)contentRect.y, (int)contentRect.width, (int)contentRect.height);
         float y = contentRect.y + contentRect.height - 25;
-        DrawTextEx(font, ("> " + inputBuffer + "_").c_str(), {contentRect.x + 5, y}, Config::FONT_SIZE_UI, 1, theme.keyword);
+        textBatch.text(font, frameArena.format("> %s_", inputBuffer.c_str()), {contentRect.x + 5, y}, Config::FONT_SIZE_UI, 1, theme.keyword);
         for (int i = displayHistory.size() - 1; i >= 0; i--) {
             y -= 22; if (y < contentRect.y) break;
-            DrawTextEx(font, displayHistory[i].c_str(), {contentRect.x + 5, y}, Config::FONT_SIZE_UI, 1, theme.text);
+            textBatch.text(font, displayHistory[i], {contentRect.x + 5, y}, Config::FONT_SIZE_UI, 1, theme.text);
         }
+        textBatch.flush();
     EndScissorMode();
 }
\ No newline at end of file
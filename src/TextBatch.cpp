@@ -0,0 +1,178 @@
+#include "../include/TextBatch.hpp"
+#include "rlgl.h"
+#include <algorithm>
+#include <cstring>
+
+TextBatch textBatch;
+
+// Same result as raylib's GetCodepointNext, but bounded by the view instead
+// of a terminating NUL: an invalid or cut-off sequence is one byte of '?'.
+static int DecodeUtf8(std::string_view s, size_t i, int& bytes) {
+    unsigned char c = (unsigned char)s[i];
+    bytes = 1;
+    if (c < 0x80) return c;
+    int len = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+    if (len == 0 || i + len > s.size()) return '?';
+    int cp = c & (0xFF >> (len + 1));
+    for (int k = 1; k < len; k++) {
+        unsigned char next = (unsigned char)s[i + k];
+        if ((next & 0xC0) != 0x80) return '?';
+        cp = (cp << 6) | (next & 0x3F);
+    }
+    bytes = len;
+    return cp;
+}
+
+TextBatch::Atlas& TextBatch::atlasFor(const Font& font, int& index) {
+    for (size_t i = 0; i < atlases.size(); i++) {
+        if (atlases[i].texture != font.texture.id) continue;
+        if (atlases[i].glyphs != font.glyphs) {
+            atlases[i].glyphs = font.glyphs;
+            std::fill(std::begin(atlases[i].lookup), std::end(atlases[i].lookup), -1);
+        }
+        index = (int)i;
+        return atlases[i];
+    }
+    atlases.emplace_back();
+    Atlas& a = atlases.back();
+    a.texture = font.texture.id;
+    a.glyphs = font.glyphs;
+    std::fill(std::begin(a.lookup), std::end(a.lookup), -1);
+    index = (int)atlases.size() - 1;
+    return a;
+}
+
+float TextBatch::text(const Font& font, std::string_view s, Vector2 pos, float size, float spacing, Color color) {
+    current.calls++;
+    if (font.texture.id == 0 || font.glyphs == nullptr || s.empty()) return 0.0f;
+
+    int index;
+    Atlas& a = atlasFor(font, index);
+    if (rowOpen && openAtlas < 0) {
+        openAtlas = index;
+        openStart = a.quads.size();
+    }
+
+    float scale = size / font.baseSize;
+    float pad = (float)font.glyphPadding;
+    float texW = (float)font.texture.width, texH = (float)font.texture.height;
+    float pen = 0.0f;
+    for (size_t i = 0; i < s.size();) {
+        int bytes;
+        int cp = DecodeUtf8(s, i, bytes);
+        i += bytes;
+
+        int g;
+        if (cp < LOOKUP_SIZE) {
+            if (a.lookup[cp] < 0) a.lookup[cp] = GetGlyphIndex(font, cp);
+            g = a.lookup[cp];
+        } else {
+            g = GetGlyphIndex(font, cp);
+        }
+        const GlyphInfo& glyph = font.glyphs[g];
+        const Rectangle& rec = font.recs[g];
+
+        if (cp != ' ' && cp != '\t') {
+            float x = pos.x + pen + (glyph.offsetX - pad) * scale;
+            float y = pos.y + (glyph.offsetY - pad) * scale;
+            float w = rec.width + 2.0f * pad, h = rec.height + 2.0f * pad;
+            a.quads.push_back({x, y, x + w * scale, y + h * scale,
+                               (rec.x - pad) / texW, (rec.y - pad) / texH,
+                               (rec.x - pad + w) / texW, (rec.y - pad + h) / texH,
+                               color});
+        }
+        pen += (glyph.advanceX != 0 ? (float)glyph.advanceX : rec.width) * scale + spacing;
+    }
+    return pen;
+}
+
+bool TextBatch::reuseRow(uint64_t key) {
+    auto it = rows.find(key);
+    if (it != rows.end()) {
+        Row& row = it->second;
+        row.frame = frame;
+        current.rowsReused++;
+        for (Atlas& a : atlases) {
+            if (a.texture == row.texture) {
+                a.quads.insert(a.quads.end(), row.quads.begin(), row.quads.end());
+                break;
+            }
+        }
+        return true;
+    }
+    rowOpen = true;
+    openKey = key;
+    openAtlas = -1;
+    return false;
+}
+
+void TextBatch::endRow() {
+    if (!rowOpen) return;
+    rowOpen = false;
+    auto it = rows.find(openKey);
+    if (it == rows.end() && !spare.empty()) {
+        spare.back().key() = openKey;
+        it = rows.insert(std::move(spare.back())).position;
+        spare.pop_back();
+    } else if (it == rows.end()) it = rows.emplace(openKey, Row()).first;
+    Row& row = it->second;
+    row.frame = frame;
+    row.quads.clear();
+    if (openAtlas >= 0) {
+        const Atlas& a = atlases[openAtlas];
+        row.texture = a.texture;
+        row.quads.assign(a.quads.begin() + openStart, a.quads.end());
+    }
+    current.rowsBuilt++;
+}
+
+void TextBatch::flush() {
+    for (Atlas& a : atlases) {
+        if (a.quads.empty()) continue;
+        current.draws++;
+        for (size_t first = 0; first < a.quads.size(); first += RUN_QUADS) {
+            size_t count = std::min(RUN_QUADS, a.quads.size() - first);
+            if (rlCheckRenderBatchLimit((int)count * 4)) current.draws++;
+            rlSetTexture(a.texture);
+            rlBegin(RL_QUADS);
+            for (size_t i = first; i < first + count; i++) {
+                const Quad& q = a.quads[i];
+                rlColor4ub(q.color.r, q.color.g, q.color.b, q.color.a);
+                rlTexCoord2f(q.u0, q.v0); rlVertex2f(q.x0, q.y0);
+                rlTexCoord2f(q.u0, q.v1); rlVertex2f(q.x0, q.y1);
+                rlTexCoord2f(q.u1, q.v1); rlVertex2f(q.x1, q.y1);
+                rlTexCoord2f(q.u1, q.v0); rlVertex2f(q.x1, q.y0);
+            }
+            rlEnd();
+        }
+        rlSetTexture(0);
+        current.quads += a.quads.size();
+        a.quads.clear();
+    }
+}
+
+void TextBatch::endFrame() {
+    flush();
+    for (auto it = rows.begin(); it != rows.end();) {
+        if (it->second.frame != frame) spare.push_back(rows.extract(it++));
+        else ++it;
+    }
+    if (spare.size() > rows.size()) spare.resize(rows.size());
+    frame++;
+    last = current;
+    current = {};
+}
+
+uint64_t TextBatch::rowKey(std::string_view text, Vector2 pos, const Font& font, float size, uint64_t salt) {
+    uint64_t h = std::hash<std::string_view>()(text);
+    auto mix = [&h](uint64_t v) { h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2); };
+    uint32_t bits[3];
+    memcpy(&bits[0], &pos.x, 4);
+    memcpy(&bits[1], &pos.y, 4);
+    memcpy(&bits[2], &size, 4);
+    mix(((uint64_t)bits[0] << 32) | bits[1]);
+    mix(((uint64_t)bits[2] << 32) | font.texture.id);
+    mix((uint64_t)(uintptr_t)font.glyphs);
+    mix(salt);
+    return h;
+}
@@ -0,0 +1,264 @@
+#include "../include/WordIndex.hpp"
+#include "../include/Encoding.hpp"
+#include <filesystem>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+static bool IsIdentStart(unsigned char c) { return isalpha(c) || c == '_'; }
+static bool IsIdentChar(unsigned char c) { return isalnum(c) || c == '_'; }
+
+static bool IsIndexedSource(const fs::path& p) {
+    static const char* exts[] = { ".c", ".h", ".cpp", ".hpp", ".cc", ".hh", ".cxx", ".inl", ".py", ".js", ".ts", ".java", ".go", ".rs", ".lua", ".cs", ".txt", ".md" };
+    std::string ext = p.extension().string();
+    for (const char* e : exts) if (ext == e) return true;
+    return false;
+}
+
+WordIndex::~WordIndex() { stop(); }
+
+void WordIndex::start() {
+    if (running) return;
+    running = true;
+    worker = std::thread(&WordIndex::workerLoop, this);
+}
+
+void WordIndex::stop() {
+    folderScan.cancel();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) return;
+        running = false;
+    }
+    cv.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+void WordIndex::push(Command cmd) {
+    std::lock_guard<std::mutex> lock(mtx);
+    pending.push_back(std::move(cmd));
+}
+
+void WordIndex::load(int docId, const std::string& path) { push({'L', docId, 0, 0, {}, path}); }
+void WordIndex::close(int docId) { push({'C', docId, 0, 0, {}, ""}); }
+
+// The scan only reads files, so it runs as a background job and the worker
+// merely swaps in its counts. Opening another folder cancels a scan in flight.
+void WordIndex::addFolder(const std::string& path) {
+    folderScan.reset();
+    auto found = std::make_shared<std::unordered_map<std::string, uint32_t>>();
+    CancelToken token = folderScan.token();
+    JobSystem::instance().submit("words.folder", JobPriority::Background, [found, path, token]() {
+        scanFolder(path, *found, token);
+    }, token, [this, found]() {
+        Command cmd{'F', 0, 0, 0, {}, ""};
+        cmd.folderWords = std::move(*found);
+        push(std::move(cmd));
+    });
+}
+
+// Replace lines [first, first+oldCount) of the indexed text with lines[first, first+newCount).
+void WordIndex::splice(int docId, int first, int oldCount, const std::vector<std::string>& lines, int newCount, std::shared_ptr<const PastedText> pasted) {
+    Command cmd{'S', docId, first, oldCount, {}, "", std::move(pasted)};
+    if (cmd.pasted) { push(std::move(cmd)); return; }
+    cmd.lines.reserve(newCount);
+    // scanLine skips overlong lines anyway, so don't copy them to the worker.
+    for (int i = 0; i < newCount; i++) { const std::string& l = lines[first + i]; cmd.lines.push_back(l.size() > Config::MAX_SCANNED_LINE ? std::string() : l); }
+    push(std::move(cmd));
+}
+
+uint32_t WordIndex::intern(std::string_view word) {
+    auto it = ids.find(word);
+    if (it != ids.end()) return it->second;
+    uint32_t id = (uint32_t)words.size();
+    words.emplace_back(word);
+    counts.push_back(0);
+    fresh.push_back(id);
+    ids.emplace(std::string_view(words.back()), id);
+    return id;
+}
+
+template <typename F>
+static void ForEachWord(const std::string& line, F&& f) {
+    if (line.size() > Config::MAX_SCANNED_LINE) return;
+    size_t i = 0, n = line.size();
+    while (i < n) {
+        unsigned char c = line[i];
+        if (!IsIdentChar(c)) { i++; continue; }
+        size_t start = i;
+        while (i < n && IsIdentChar((unsigned char)line[i])) i++;
+        size_t len = i - start;
+        if (IsIdentStart(c) && len >= WordIndex::MIN_WORD && len <= WordIndex::MAX_WORD) f(std::string_view(line).substr(start, len));
+    }
+}
+
+void WordIndex::scanLine(const std::string& line, std::vector<uint32_t>& out) {
+    ForEachWord(line, [&](std::string_view word) { out.push_back(intern(word)); });
+}
+
+// Scans line into the end of doc's pool and counts its words.
+std::pair<uint32_t, uint32_t> WordIndex::addRun(DocWords& doc, const std::string& line) {
+    size_t start = doc.pool.size();
+    scanLine(line, doc.pool);
+    for (size_t i = start; i < doc.pool.size(); i++) counts[doc.pool[i]]++;
+    return {(uint32_t)start, (uint32_t)(doc.pool.size() - start)};
+}
+
+void WordIndex::compact(DocWords& doc) {
+    std::vector<uint32_t> pool;
+    pool.reserve(doc.pool.size() - doc.garbage);
+    for (auto& run : doc.runs) {
+        uint32_t start = (uint32_t)pool.size();
+        pool.insert(pool.end(), doc.pool.begin() + run.first, doc.pool.begin() + run.first + run.second);
+        run.first = start;
+    }
+    doc.pool.swap(pool);
+    doc.garbage = 0;
+}
+
+void WordIndex::process(Command& cmd) {
+    if (cmd.type == 'L' || cmd.type == 'C') {
+        auto it = docLines.find(cmd.docId);
+        if (it != docLines.end()) {
+            for (const auto& run : it->second.runs) for (uint32_t i = 0; i < run.second; i++) counts[it->second.pool[run.first + i]]--;
+            docLines.erase(it);
+            changed = true;
+        }
+        if (cmd.type == 'C') return;
+        DocWords& doc = docLines[cmd.docId];
+        // Walked straight from the file's text; a final newline doesn't start a line.
+        std::string text;
+        ReadTextFile(cmd.path, text);
+        std::string_view body(text);
+        if (!body.empty() && body.back() == '\n') body.remove_suffix(1);
+        ForEachLine("", body, "", [&](const std::string& line) { doc.runs.push_back(addRun(doc, line)); });
+        changed = true;
+    } else if (cmd.type == 'S') {
+        // A document seen for the first time starts as the single empty line of a new buffer.
+        DocWords& doc = docLines[cmd.docId];
+        if (doc.runs.empty()) doc.runs.push_back({0, 0});
+        int first = std::min(cmd.first, (int)doc.runs.size());
+        int oldCount = std::min(cmd.oldCount, (int)doc.runs.size() - first);
+        for (int i = first; i < first + oldCount; i++) {
+            const auto& run = doc.runs[i];
+            for (uint32_t k = 0; k < run.second; k++) counts[doc.pool[run.first + k]]--;
+            doc.garbage += run.second;
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> repl;
+        repl.reserve(cmd.pasted ? cmd.pasted->lineCount : cmd.lines.size());
+        auto scan = [&](const std::string& line) { repl.push_back(addRun(doc, line)); };
+        if (cmd.pasted) ForEachLine(cmd.pasted->head, cmd.pasted->body, cmd.pasted->tail, scan);
+        else for (const std::string& line : cmd.lines) scan(line);
+        if (oldCount == (int)repl.size()) std::copy(repl.begin(), repl.end(), doc.runs.begin() + first);
+        else {
+            doc.runs.erase(doc.runs.begin() + first, doc.runs.begin() + first + oldCount);
+            doc.runs.insert(doc.runs.begin() + first, repl.begin(), repl.end());
+        }
+        if (doc.garbage > doc.pool.size() / 2) compact(doc);
+        changed = true;
+    } else if (cmd.type == 'F') {
+        mergeFolder(cmd.folderWords);
+    }
+}
+
+// Folder words are counted once and never tracked per line; opening another
+// folder replaces them.
+void WordIndex::mergeFolder(std::unordered_map<std::string, uint32_t>& found) {
+    for (auto& [id, n] : folderCounts) counts[id] -= n;
+    folderCounts.clear();
+    for (auto& [word, n] : found) {
+        uint32_t id = intern(word);
+        counts[id] += n;
+        folderCounts[id] += n;
+    }
+    changed = true;
+}
+
+// Runs on a job, away from the worker's state: words are keyed by text here.
+void WordIndex::scanFolder(const std::string& path, std::unordered_map<std::string, uint32_t>& found, const CancelToken& token) {
+    std::error_code ec;
+    std::string line, key;
+    for (fs::recursive_directory_iterator it(path, fs::directory_options::skip_permission_denied, ec), end; it != end && !token.cancelled(); it.increment(ec)) {
+        if (ec) break;
+        const fs::path& p = it->path();
+        if (it->is_directory(ec)) { if (p.filename().string().rfind('.', 0) == 0) it.disable_recursion_pending(); continue; }
+        if (!IsIndexedSource(p) || it->file_size(ec) > MAX_FILE_BYTES) continue;
+        std::ifstream in(p);
+        while (std::getline(in, line)) ForEachWord(line, [&](std::string_view word) { key.assign(word); found[key]++; });
+    }
+}
+
+void WordIndex::publish() {
+    changed = false;
+    if (!fresh.empty()) {
+        auto byWord = [this](uint32_t a, uint32_t b) { return words[a] < words[b]; };
+        std::sort(fresh.begin(), fresh.end(), byWord);
+        size_t mid = sorted.size();
+        sorted.insert(sorted.end(), fresh.begin(), fresh.end());
+        std::inplace_merge(sorted.begin(), sorted.begin() + mid, sorted.end(), byWord);
+        fresh.clear();
+    }
+    auto snap = std::make_shared<Snapshot>();
+    snap->entries.reserve(sorted.size());
+    for (uint32_t id : sorted) if (counts[id] > 0) snap->entries.push_back({&words[id], counts[id]});
+    std::lock_guard<std::mutex> lock(snapMtx);
+    snapshot = std::move(snap);
+}
+
+void WordIndex::workerLoop() {
+    std::vector<Command> batch;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait_for(lock, std::chrono::duration<float>(publishInterval), [this] { return !running; });
+        if (!running) break;
+        batch.swap(pending);
+        lock.unlock();
+
+        for (Command& cmd : batch) process(cmd);
+        batch.clear();
+        if (changed) publish();
+        lock.lock();
+    }
+}
+
+void WordIndex::complete(const std::string& prefix, std::vector<std::string>& out, size_t maxResults) {
+    out.clear();
+    std::shared_ptr<const Snapshot> snap;
+    {
+        std::lock_guard<std::mutex> lock(snapMtx);
+        snap = snapshot;
+    }
+    if (!snap || prefix.empty()) return;
+    const std::vector<Entry>& entries = snap->entries;
+    auto byWord = [](const Entry& e, const std::string& p) { return *e.word < p; };
+
+    std::vector<std::pair<float, const Entry*>> hits;
+    auto it = std::lower_bound(entries.begin(), entries.end(), prefix, byWord);
+    for (int scanned = 0; it != entries.end() && scanned < SCAN_LIMIT; ++it, scanned++) {
+        if (it->word->compare(0, prefix.size(), prefix) != 0) break;
+        if (it->word->size() > prefix.size()) hits.push_back({(float)it->count, &*it});
+    }
+    auto take = [&](size_t limit) {
+        size_t n = std::min(limit, hits.size());
+        std::partial_sort(hits.begin(), hits.begin() + n, hits.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (size_t i = 0; i < n; i++) out.push_back(*hits[i].second->word);
+    };
+    take(maxResults);
+    if (out.size() >= maxResults) return;
+
+    // Fuzzy: same first character, remaining characters in order, ranked by
+    // frequency over how spread out the match is.
+    hits.clear();
+    it = std::lower_bound(entries.begin(), entries.end(), prefix.substr(0, 1), byWord);
+    for (int scanned = 0; it != entries.end() && scanned < SCAN_LIMIT; ++it, scanned++) {
+        const std::string& w = *it->word;
+        if (w[0] != prefix[0]) break;
+        if (w.compare(0, prefix.size(), prefix) == 0) continue;
+        size_t p = 1, last = 0;
+        for (size_t i = 1; i < w.size() && p < prefix.size(); i++) {
+            if (tolower((unsigned char)w[i]) == tolower((unsigned char)prefix[p])) { p++; last = i; }
+        }
+        if (p == prefix.size()) hits.push_back({(float)it->count / (float)(1 + last + 1 - prefix.size()), &*it});
+    }
+    take(maxResults - out.size());
+}
@@ -0,0 +1,235 @@
+#include "../include/WrapIndex.hpp"
+#include "../include/JobSystem.hpp"
+
+enum { SPACE, WORD, PUNCT };
+
+static int ClassOf(unsigned char c) {
+    if (c == ' ' || c == '\t') return SPACE;
+    return (c >= 0x80 || isalnum(c) || c == '_') ? WORD : PUNCT;
+}
+
+// A row may start at byte i after whitespace, or where a word meets punctuation.
+// Every byte of a multi-byte codepoint is WORD, so no break falls inside one.
+static bool BreakBefore(const unsigned char* s, size_t i) {
+    int prev = ClassOf(s[i - 1]), cls = ClassOf(s[i]);
+    return prev == SPACE || (cls != SPACE && cls != prev);
+}
+
+// Greedy: a row takes as many codepoints as fit, then goes back to the last
+// break it passed; without one in the row, the row is cut at the width.
+// Only the bytes around each row end are classified, the rest is just counted.
+int WrapIndex::layout(const std::string& text, int width, int& cols, std::vector<int>* rowStarts) {
+    if (rowStarts) rowStarts->assign(1, 0);
+    if ((int)text.size() <= width) { cols = Utf8Length(text); return 1; }
+    const unsigned char* s = (const unsigned char*)text.data();
+    size_t n = text.size(), from = 0;
+    int rows = 1, start = 0;
+    while (true) {
+        // Count lead bytes in blocks that cannot overshoot the width.
+        size_t end = from;
+        int taken = 0;
+        while (taken < width && end < n) {
+            size_t stop = std::min(n, end + (width - taken));
+            for (size_t i = end; i < stop; i++) taken += (s[i] & 0xC0) != 0x80;
+            end = stop;
+        }
+        while (end < n && (s[end] & 0xC0) == 0x80) end++;
+        if (end >= n) { cols = start + taken; return rows; }
+        size_t cut = end;
+        while (cut > from && !BreakBefore(s, cut)) cut--;
+        if (cut == from) cut = end;
+        for (size_t i = cut; i < end; i++) taken -= (s[i] & 0xC0) != 0x80;
+        from = cut;
+        start += taken;
+        rows++;
+        if (rowStarts) rowStarts->push_back(start);
+    }
+}
+
+void WrapIndex::buildTree(const std::vector<int>& rows, std::vector<int>& tree) {
+    int n = (int)rows.size();
+    tree.assign(n + 1, 0);
+    for (int i = 1; i <= n; i++) {
+        tree[i] += rows[i - 1];
+        int j = i + (i & -i);
+        if (j <= n) tree[j] += tree[i];
+    }
+}
+
+// Nodes up to staleFrom only cover lines before it and are still right. Of the
+// rest, each starts from its own line and takes in its children, the valid
+// ones being the O(log n) nodes that sum the lines before staleFrom.
+void WrapIndex::refreshTree() const {
+    if (staleFrom == INT_MAX) return;
+    int n = (int)rows.size(), s = staleFrom + 1;
+    staleFrom = INT_MAX;
+    for (int i = s; i <= n; i++) tree[i] = rows[i - 1];
+    for (int c = s - 1; c > 0; c -= c & -c) {
+        int p = c + (c & -c);
+        if (p >= s && p <= n) tree[p] += tree[c];
+    }
+    for (int i = s; i <= n; i++) {
+        int j = i + (i & -i);
+        if (j <= n) tree[j] += tree[i];
+    }
+}
+
+void WrapIndex::addRows(int line, int delta) {
+    for (int i = line + 1; i < (int)tree.size(); i += i & -i) tree[i] += delta;
+}
+
+void WrapIndex::clear() {
+    wrapWidth = 0; cols.clear(); rows.clear(); tree.clear(); starts.clear(); staleFrom = INT_MAX;
+    pending.reset(); touchedSinceJob.clear();
+}
+
+void WrapIndex::reset(const std::vector<std::string>& lines, int width) {
+    clear();
+    wrapWidth = std::max(1, width);
+    cols.resize(lines.size()); rows.resize(lines.size());
+    for (size_t i = 0; i < lines.size(); i++) rows[i] = layout(lines[i], wrapWidth, cols[i]);
+    buildTree(rows, tree);
+}
+
+// Lays out one line again in place. An edited line that still wraps keeps its
+// row starts, since the caret is usually on it.
+void WrapIndex::relayLine(const std::vector<std::string>& lines, int line) {
+    std::vector<int> rowStarts;
+    int r = layout(lines[line], wrapWidth, cols[line], &rowStarts);
+    if (r != rows[line]) { addRows(line, r - rows[line]); rows[line] = r; }
+    if (r > 1 && starts.size() < MAX_CACHED_LINES) starts[line].swap(rowStarts);
+    else starts.erase(line);
+}
+
+// Same coordinates as Document::edits: lines [first, first+oldCount) were replaced by [first, first+newCount).
+void WrapIndex::splice(int first, int oldCount, const std::vector<std::string>& lines, int newCount) {
+    if (!isBuilt()) return;
+    if (oldCount == newCount) {
+        for (int i = 0; i < newCount; i++) {
+            relayLine(lines, first + i);
+            if (pending) touchedSinceJob.push_back(first + i);
+        }
+        return;
+    }
+    // Line count changed: later lines move, so their cached row starts move with
+    // them and the tree nodes past 'first' are rebuilt on the next lookup, once
+    // however many splices came before it.
+    std::unordered_map<int, std::vector<int>> moved;
+    for (auto& [line, s] : starts) {
+        if (line < first) moved[line].swap(s);
+        else if (line >= first + oldCount) moved[line + newCount - oldCount].swap(s);
+    }
+    starts.swap(moved);
+    cols.erase(cols.begin() + first, cols.begin() + first + oldCount);
+    rows.erase(rows.begin() + first, rows.begin() + first + oldCount);
+    std::vector<int> newCols(newCount), newRows(newCount);
+    for (int i = 0; i < newCount; i++) newRows[i] = layout(lines[first + i], wrapWidth, newCols[i]);
+    cols.insert(cols.begin() + first, newCols.begin(), newCols.end());
+    rows.insert(rows.begin() + first, newRows.begin(), newRows.end());
+    tree.resize(rows.size() + 1);
+    staleFrom = std::min(staleFrom, first);
+    structureGen++;
+}
+
+// Only lines longer than the width can wrap, so only their text goes to the worker.
+void WrapIndex::startJob(const std::vector<std::string>& lines) {
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->width = pendingWidth;
+    job->cols = cols;
+    for (size_t i = 0; i < cols.size(); i++) if (cols[i] > pendingWidth) job->wide.emplace_back((int)i, lines[i]);
+    pending = job;
+    jobGen = structureGen;
+    touchedSinceJob.clear();
+    superseded.reset();
+    JobSystem::instance().submit("wrap.rebuild", JobPriority::Interactive, [job]() {
+        job->rows.assign(job->cols.size(), 1);
+        int c;
+        for (const auto& [line, text] : job->wide) job->rows[line] = layout(text, job->width, c);
+        buildTree(job->rows, job->tree);
+        job->done = true;
+    }, superseded.token());
+}
+
+void WrapIndex::requestWidth(const std::vector<std::string>& lines, int width) {
+    width = std::max(1, width);
+    if (!isBuilt() || width == targetWidth()) return;
+    pendingWidth = width;
+    if ((int)cols.size() < ASYNC_THRESHOLD) {
+        pending.reset();
+        wrapWidth = width;
+        starts.clear();
+        for (size_t i = 0; i < cols.size(); i++) rows[i] = cols[i] <= wrapWidth ? 1 : layout(lines[i], wrapWidth, cols[i]);
+        buildTree(rows, tree);
+        staleFrom = INT_MAX;
+        return;
+    }
+    // Keep laying out at the old width until the worker's result lands.
+    startJob(lines);
+}
+
+void WrapIndex::poll(const std::vector<std::string>& lines) {
+    if (!pending || !pending->done) return;
+    std::shared_ptr<Job> job = pending;
+    pending.reset();
+    if (jobGen != structureGen) { startJob(lines); return; }
+    wrapWidth = job->width;
+    rows.swap(job->rows);
+    tree.swap(job->tree);
+    staleFrom = INT_MAX;
+    starts.clear();
+    // Lines edited in place while the worker ran were laid out from its stale copy.
+    for (int line : touchedSinceJob) relayLine(lines, line);
+    touchedSinceJob.clear();
+}
+
+int WrapIndex::totalRows() const { return rowOfLine((int)rows.size()); }
+
+int WrapIndex::rowOfLine(int line) const {
+    refreshTree();
+    int sum = 0;
+    for (int i = std::min(line, (int)rows.size()); i > 0; i -= i & -i) sum += tree[i];
+    return sum;
+}
+
+void WrapIndex::find(int visualRow, int& line, int& sub) const {
+    int n = (int)rows.size();
+    if (n == 0) { line = 0; sub = 0; return; }
+    refreshTree();
+    if (visualRow < 0) visualRow = 0;
+    int pos = 0, rem = visualRow, step = 1;
+    while (step * 2 <= n) step *= 2;
+    for (; step > 0; step >>= 1) {
+        if (pos + step <= n && tree[pos + step] <= rem) { pos += step; rem -= tree[pos]; }
+    }
+    if (pos >= n) { line = n - 1; sub = rows[n - 1] - 1; return; }
+    line = pos; sub = rem;
+}
+
+const std::vector<int>& WrapIndex::startsOf(const std::string& text, int line) const {
+    auto it = starts.find(line);
+    if (it != starts.end()) return it->second;
+    if (starts.size() >= MAX_CACHED_LINES) starts.clear();
+    std::vector<int>& s = starts[line];
+    int c;
+    layout(text, wrapWidth, c, &s);
+    return s;
+}
+
+int WrapIndex::rowStart(const std::string& text, int line, int sub) const {
+    if (sub <= 0 || rowsOf(line) <= 1) return 0;
+    const std::vector<int>& s = startsOf(text, line);
+    return s[std::min(sub, (int)s.size() - 1)];
+}
+
+int WrapIndex::rowEnd(const std::string& text, int line, int sub) const {
+    if (sub + 1 >= rowsOf(line)) return line < (int)cols.size() ? cols[line] : Utf8Length(text);
+    return rowStart(text, line, sub + 1);
+}
+
+// A column on a break belongs to the row it starts.
+int WrapIndex::subRowOf(const std::string& text, int line, int col) const {
+    if (rowsOf(line) <= 1) return 0;
+    const std::vector<int>& s = startsOf(text, line);
+    int sub = (int)(std::upper_bound(s.begin(), s.end(), col) - s.begin()) - 1;
+    return std::min(sub, rowsOf(line) - 1);
+}
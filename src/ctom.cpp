@@ -2,7 +2,13 @@
 #include "../include/Editor.hpp"
 #include "../include/FileManager.hpp"
 #include "../include/Terminal.hpp"
+#include "../include/FontCache.hpp"
+#include "../include/JobSystem.hpp"
+#include "../include/FrameArena.hpp"
+#include "../include/Session.hpp"
+#include "../include/TextBatch.hpp"
 #include <cstdlib> 
+#include <chrono>
 
 struct AppState {
     bool showMenuFile = false; 
@@ -15,27 +21,28 @@ struct AppState {
     int focus = 0; 
     int editingField = 0; 
     int inputCursor = 0;
+    bool fontReload = false;
 };
 
 // --- UI HELPERS ---
 
 bool DrawMenuBtn(Rectangle r, const char* text, Font font, Color bgColor, Color textColor = theme.menuText) {
-    bool hover = CheckCollisionPointRec(GetMousePosition(), r);
+    bool hover = CheckCollisionPointRec(Input::GetMousePosition(), r);
     DrawRectangleRec(r, hover ? theme.menuHover : bgColor);
     if(hover) DrawRectangleLinesEx(r, 1, theme.border);
     Vector2 textSize = MeasureTextEx(font, text, (float)Config::FONT_SIZE_SMALL, 1);
     float textX = r.x + (r.width - textSize.x) / 2;
     float textY = r.y + (r.height - textSize.y) / 2;
     DrawTextEx(font, text, {textX, textY}, (float)Config::FONT_SIZE_SMALL, 1, textColor);
-    return hover && IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    return hover && Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
 }
 
 bool DrawToggleBtn(float x, float y, Font font, Color bgColor) {
     Rectangle r = {x, y, 20, 20};
-    bool hover = CheckCollisionPointRec(GetMousePosition(), r);
+    bool hover = CheckCollisionPointRec(Input::GetMousePosition(), r);
     DrawRectangleRec(r, hover ? theme.closeBtn : bgColor);
     DrawTextEx(font, "x", {x + 6, y + 2}, 16, 1, hover ? WHITE : theme.text);
-    return hover && IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    return hover && Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
 }
 
 bool DrawMenuItem(float x, float y, float w, const char* text, Font font) { 
@@ -48,21 +55,20 @@ void DrawColorSlider(Rectangle bounds, const char* label, unsigned char* value,
     DrawRectangleRec(bar, GRAY);
     float pct = (float)(*value) / 255.0f;
     DrawRectangle((int)(bar.x + (bar.width * pct) - 5), (int)(bar.y - 2), 10, 19, WHITE);
-    if (CheckCollisionPointRec(GetMousePosition(), {bar.x - 5, bar.y - 5, bar.width + 10, 25}) && IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-        float rel = GetMousePosition().x - bar.x; rel = Clamp(rel, 0, bar.width);
+    if (CheckCollisionPointRec(Input::GetMousePosition(), {bar.x - 5, bar.y - 5, bar.width + 10, 25}) && Input::IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
+        float rel = Input::GetMousePosition().x - bar.x; rel = Clamp(rel, 0, bar.width);
         *value = (unsigned char)((rel / bar.width) * 255);
     }
-    std::string valStr = std::to_string(*value);
-    DrawTextEx(font, valStr.c_str(), {bar.x + bar.width + 10, bounds.y}, 18, 1, theme.text);
+    DrawTextEx(font, frameArena.format("%d", *value), {bar.x + bar.width + 10, bounds.y}, 18, 1, theme.text);
 }
 
 void HandleTextInput(std::string& target, int& cursor) {
     if (cursor > (int)target.size()) cursor = target.size();
-    int c = GetCharPressed();
-    while (c > 0) { if (c >= 32 && c <= 126) { target.insert(cursor, 1, (char)c); cursor++; } c = GetCharPressed(); }
-    if (IsKeyPressed(KEY_BACKSPACE) && cursor > 0 && !target.empty()) { target.erase(cursor - 1, 1); cursor--; }
-    if (IsKeyPressed(KEY_LEFT) && cursor > 0) cursor--;
-    if (IsKeyPressed(KEY_RIGHT) && cursor < (int)target.size()) cursor++;
+    int c = Input::GetCharPressed();
+    while (c > 0) { if (c >= 32 && c <= 126) { target.insert(cursor, 1, (char)c); cursor++; } c = Input::GetCharPressed(); }
+    if (Input::IsKeyPressed(KEY_BACKSPACE) && cursor > 0 && !target.empty()) { target.erase(cursor - 1, 1); cursor--; }
+    if (Input::IsKeyPressed(KEY_LEFT) && cursor > 0) cursor--;
+    if (Input::IsKeyPressed(KEY_RIGHT) && cursor < (int)target.size()) cursor++;
 }
 
 // --- SETTINGS UI ---
@@ -93,12 +99,12 @@ void DrawSettings(Rectangle bounds, Font font, Editor& editor, AppState& app) {
         DrawTextEx(font, "Commonly Used", {contentX, contentY}, 22, 1, theme.keyword); contentY += 40;
         DrawTextEx(font, "Font Size:", {contentX, contentY}, 18, 1, theme.text);
         if(DrawMenuBtn({contentX + 100, contentY - 5, 30, 30}, "-", font, theme.btnNormal)) { if(settings.fontSize > 10) settings.fontSize-=2; editor.updateFontMetrics(); }
-        DrawTextEx(font, std::to_string(settings.fontSize).c_str(), {contentX + 140, contentY}, 18, 1, theme.text);
+        DrawTextEx(font, frameArena.format("%d", settings.fontSize), {contentX + 140, contentY}, 18, 1, theme.text);
         if(DrawMenuBtn({contentX + 170, contentY - 5, 30, 30}, "+", font, theme.btnNormal)) { settings.fontSize+=2; editor.updateFontMetrics(); }
         contentY += 50;
         DrawTextEx(font, "Tab Size:", {contentX, contentY}, 18, 1, theme.text);
         if(DrawMenuBtn({contentX + 100, contentY - 5, 30, 30}, "-", font, theme.btnNormal)) { if(settings.tabSize > 2) settings.tabSize-=2; }
-        DrawTextEx(font, std::to_string(settings.tabSize).c_str(), {contentX + 140, contentY}, 18, 1, theme.text);
+        DrawTextEx(font, frameArena.format("%d", settings.tabSize), {contentX + 140, contentY}, 18, 1, theme.text);
         if(DrawMenuBtn({contentX + 170, contentY - 5, 30, 30}, "+", font, theme.btnNormal)) { if(settings.tabSize < 8) settings.tabSize+=2; }
         contentY += 50;
     } 
@@ -108,14 +114,20 @@ void DrawSettings(Rectangle bounds, Font font, Editor& editor, AppState& app) {
         Rectangle fontBox = {contentX, contentY + 25, contentW - 80, 30};
         DrawRectangleRec(fontBox, app.editingField == 1 ? theme.bg : theme.border);
         DrawTextEx(font, settings.fontPath.c_str(), {fontBox.x+5, fontBox.y+5}, 18, 1, theme.text);
-        if(CheckCollisionPointRec(GetMousePosition(), fontBox) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { app.editingField=1; app.inputCursor=settings.fontPath.size(); }
+        if(CheckCollisionPointRec(Input::GetMousePosition(), fontBox) && Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { app.editingField=1; app.inputCursor=settings.fontPath.size(); }
         if(DrawMenuBtn({fontBox.x+fontBox.width+10, fontBox.y, 70, 30}, "Browse", font, theme.btnNormal)) {
             std::string f = OpenWindowsFilePicker("assets/"); if(!f.empty()) settings.fontPath = f;
         }
         if (app.editingField == 1) HandleTextInput(settings.fontPath, app.inputCursor);
         contentY += 70;
-        std::string lineBtn = std::string("Line Numbers: ") + (settings.showLineNumbers ? "ON" : "OFF");
-        if(DrawMenuBtn({contentX, contentY, 200, 30}, lineBtn.c_str(), font, settings.showLineNumbers ? theme.btnNormal : theme.panelBg)) settings.showLineNumbers = !settings.showLineNumbers;
+        const char* lineBtn = frameArena.format("Line Numbers: %s", settings.showLineNumbers ? "ON" : "OFF");
+        if(DrawMenuBtn({contentX, contentY, 200, 30}, lineBtn, font, settings.showLineNumbers ? theme.btnNormal : theme.panelBg)) settings.showLineNumbers = !settings.showLineNumbers;
+        contentY += 40;
+        const char* wrapBtn = frameArena.format("Word Wrap: %s", settings.wordWrap ? "ON" : "OFF");
+        if(DrawMenuBtn({contentX, contentY, 200, 30}, wrapBtn, font, settings.wordWrap ? theme.btnNormal : theme.panelBg)) settings.wordWrap = !settings.wordWrap;
+        contentY += 40;
+        const char* mapBtn = frameArena.format("Minimap: %s", settings.showMinimap ? "ON" : "OFF");
+        if(DrawMenuBtn({contentX, contentY, 200, 30}, mapBtn, font, settings.showMinimap ? theme.btnNormal : theme.panelBg)) settings.showMinimap = !settings.showMinimap;
     }
     else if (category == 2) { // Window
         DrawTextEx(font, "Window", {contentX, contentY}, 22, 1, theme.keyword); contentY += 40;
@@ -128,7 +140,7 @@ void DrawSettings(Rectangle bounds, Font font, Editor& editor, AppState& app) {
 
         DrawTextEx(font, "Navbar Height:", {contentX, contentY}, 18, 1, theme.text);
         if(DrawMenuBtn({contentX + 130, contentY - 5, 30, 30}, "-", font, theme.btnNormal)) { if(settings.navbarHeight > 20) settings.navbarHeight-=2; }
-        DrawTextEx(font, std::to_string(settings.navbarHeight).c_str(), {contentX + 170, contentY}, 18, 1, theme.text);
+        DrawTextEx(font, frameArena.format("%d", settings.navbarHeight), {contentX + 170, contentY}, 18, 1, theme.text);
         if(DrawMenuBtn({contentX + 200, contentY - 5, 30, 30}, "+", font, theme.btnNormal)) { if(settings.navbarHeight < 60) settings.navbarHeight+=2; }
         contentY += 50;
 
@@ -156,10 +168,10 @@ void DrawSettings(Rectangle bounds, Font font, Editor& editor, AppState& app) {
         }
         contentY += 10;
         DrawTextEx(font, "Panels:", {contentX, contentY+5}, 18, 1, theme.text); 
-        std::string sideTxt = std::string("Sidebar: ") + (settings.showSidebar ? "Show" : "Hide");
-        std::string termTxt = std::string("Terminal: ") + (settings.showTerminal ? "Show" : "Hide");
-        if(DrawMenuBtn({contentX+80, contentY, 120, 30}, sideTxt.c_str(), font, settings.showSidebar ? theme.btnNormal : theme.panelBg)) settings.showSidebar = !settings.showSidebar;
-        if(DrawMenuBtn({contentX+210, contentY, 120, 30}, termTxt.c_str(), font, settings.showTerminal ? theme.btnNormal : theme.panelBg)) settings.showTerminal = !settings.showTerminal;
+        const char* sideTxt = frameArena.format("Sidebar: %s", settings.showSidebar ? "Show" : "Hide");
+        const char* termTxt = frameArena.format("Terminal: %s", settings.showTerminal ? "Show" : "Hide");
+        if(DrawMenuBtn({contentX+80, contentY, 120, 30}, sideTxt, font, settings.showSidebar ? theme.btnNormal : theme.panelBg)) settings.showSidebar = !settings.showSidebar;
+        if(DrawMenuBtn({contentX+210, contentY, 120, 30}, termTxt, font, settings.showTerminal ? theme.btnNormal : theme.panelBg)) settings.showTerminal = !settings.showTerminal;
     }
     else if (category == 3) { // System
         DrawTextEx(font, "System", {contentX, contentY}, 22, 1, theme.keyword); contentY += 40;
@@ -167,16 +179,12 @@ void DrawSettings(Rectangle bounds, Font font, Editor& editor, AppState& app) {
         Rectangle cflagBox = {contentX, contentY+25, contentW, 30};
         DrawRectangleRec(cflagBox, app.editingField == 2 ? theme.bg : theme.border);
         DrawTextEx(font, settings.cFlags.c_str(), {cflagBox.x+5, cflagBox.y+5}, 18, 1, theme.text);
-        if(CheckCollisionPointRec(GetMousePosition(), cflagBox) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { app.editingField=2; app.inputCursor=settings.cFlags.size(); }
+        if(CheckCollisionPointRec(Input::GetMousePosition(), cflagBox) && Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { app.editingField=2; app.inputCursor=settings.cFlags.size(); }
         if (app.editingField == 2) HandleTextInput(settings.cFlags, app.inputCursor);
     }
 
     if(DrawMenuBtn({contentX, bounds.y + bounds.height - 40, 140, 30}, "Save Changes", font, theme.runButton, theme.runText)) {
-        if (app.editingField == 1) { 
-            Font newFont = LoadFontEx(settings.fontPath.c_str(), 96, 0, 250);
-            SetTextureFilter(newFont.texture, TEXTURE_FILTER_BILINEAR);
-            editor.reloadFont(newFont);
-        }
+        if (app.editingField == 1) app.fontReload = true; // rasterized off-thread, swapped in by main()
         SaveSettings(); ShowToast("Settings Saved");
     }
 }
@@ -211,7 +219,7 @@ void OpenModal(AppState& app, int type) {
 void DrawToasts(Font font, int w, int h) {
     float y = h - 60;
     for (auto it = toastQueue.begin(); it != toastQueue.end();) {
-        it->lifeTime -= GetFrameTime();
+        it->lifeTime -= Input::GetFrameTime();
         if (it->lifeTime <= 0) it = toastQueue.erase(it);
         else {
             float alpha = 1.0f; if (it->lifeTime < 0.5f) alpha = it->lifeTime / 0.5f;
@@ -225,26 +233,79 @@ void DrawToasts(Font font, int w, int h) {
     }
 }
 
-int main() {
-    SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT | FLAG_VSYNC_HINT);
-    InitWindow(Config::WIN_WIDTH_DEFAULT, Config::WIN_HEIGHT_DEFAULT, "ctom"); 
-    SetTargetFPS(60); SetExitKey(KEY_NULL);
+// ctom --record out.session [files to open...]
+// ctom --replay in.session [--hashes frames.txt] [--baseline perf.txt] [--max-frame-allocs N]
+static bool StartSession(int argc, char** argv, std::string& baselinePath) {
+    if (argc < 2) return true;
+    std::string mode = argv[1];
+    if (mode == "--record" && argc >= 3) return session.record(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+    if (mode != "--replay" || argc < 3 || (argc - 3) % 2 != 0) return false;
+    for (int i = 3; i < argc; i += 2) {
+        std::string opt = argv[i];
+        if (opt == "--hashes") session.setHashOutput(argv[i + 1]);
+        else if (opt == "--baseline") baselinePath = argv[i + 1];
+        else if (opt == "--max-frame-allocs") {
+            char* end;
+            long long n = strtoll(argv[i + 1], &end, 10);
+            if (*end || end == argv[i + 1] || n < 0) return false;
+            session.setMaxFrameAllocs(n);
+        }
+        else return false;
+    }
+    return session.replay(argv[2]);
+}
+
+int main(int argc, char** argv) {
+    auto launchTime = std::chrono::steady_clock::now();
+    std::string baselinePath;
+    if (!StartSession(argc, argv, baselinePath)) {
+        fprintf(stderr, "usage: ctom [--record out.session [files...] | --replay in.session [--hashes frames.txt] [--baseline perf.txt] [--max-frame-allocs N]]\n");
+        return 2;
+    }
+    // Replays run unthrottled at the recorded window size; frame time is what they measure.
+    bool replaying = session.mode() == Session::Mode::Replay;
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT | (replaying ? 0 : FLAG_VSYNC_HINT));
+    InitWindow(session.startWidth(), session.startHeight(), "ctom"); 
+    SetTargetFPS(replaying ? 0 : Config::FPS_LIMIT); SetExitKey(KEY_NULL);
     
     Image appIconImg = LoadImage("assets/icon.png");
     Texture2D logoTexture = { 0 }; 
     if (appIconImg.data != NULL) { SetWindowIcon(appIconImg); logoTexture = LoadTextureFromImage(appIconImg); SetTextureFilter(logoTexture, TEXTURE_FILTER_BILINEAR); UnloadImage(appIconImg); }
 
-    LoadSettings();
-    Font mainFont = LoadFontEx(settings.fontPath.c_str(), 96, 0, 250);
-    SetTextureFilter(mainFont.texture, TEXTURE_FILTER_BILINEAR);
-    Editor editor; editor.init(mainFont); FileManager fileMgr; fileMgr.init(); Terminal terminal; terminal.init(); 
+    if (!session.active()) LoadSettings();
+    JobSystem::instance().setTimingHook([](const JobTiming& t) {
+        if (t.runMs + t.waitMs >= Config::SLOW_JOB_MS) TraceLog(LOG_INFO, "JOBS: %s waited %.1f ms, ran %.1f ms%s", t.name, t.waitMs, t.runMs, t.cancelled ? " (cancelled)" : "");
+    });
+    // Cached atlas loads without rasterizing; otherwise start with the default font until the worker finishes.
+    FontCache fontCache; Font mainFont; bool fontOwned = true;
+    bool fontCached = fontCache.loadCached(settings.fontPath, Config::FONT_ATLAS_SIZE, Config::FONT_GLYPH_COUNT, mainFont);
+    if (fontCached) SetTextureFilter(mainFont.texture, TEXTURE_FILTER_BILINEAR);
+    else { mainFont = GetFontDefault(); fontOwned = false; fontCache.requestAsync(settings.fontPath, Config::FONT_ATLAS_SIZE, Config::FONT_GLYPH_COUNT); }
+    Editor editor; editor.init(mainFont, session.active() ? Session::JOURNAL_DIR : "data/journal"); FileManager fileMgr; fileMgr.init(); Terminal terminal; terminal.init(); 
     AppState app; ApplyThemePreset(settings.themeIndex);
+    for (const std::string& path : session.startFiles()) editor.loadFile(path);
+    bool firstFrame = true;
+
+    while (!Input::WindowShouldClose()) {
+        session.beginFrame();
+        size_t frameAllocs = ThreadAllocationCount(), allAllocs = TotalAllocationCount();
+        JobSystem::instance().drainCompletions();
+        if (app.fontReload) { app.fontReload = false; fontCache.requestAsync(settings.fontPath, Config::FONT_ATLAS_SIZE, Config::FONT_GLYPH_COUNT); }
+        Font loadedFont; bool fontFailed = false;
+        if (fontCache.poll(loadedFont, fontFailed)) {
+            if (fontFailed) ShowToast("Font Load Failed!");
+            else {
+                SetTextureFilter(loadedFont.texture, TEXTURE_FILTER_BILINEAR);
+                if (fontOwned) UnloadFont(mainFont);
+                mainFont = loadedFont; fontOwned = true;
+                editor.reloadFont(mainFont);
+            }
+        }
 
-    while (!WindowShouldClose()) {
-        float w = (float)GetScreenWidth(); float h = (float)GetScreenHeight(); Vector2 m = GetMousePosition();
+        float w = (float)Input::GetScreenWidth(); float h = (float)Input::GetScreenHeight(); Vector2 m = Input::GetMousePosition();
         bool isModalOpen = app.showSettings || app.showAbout || app.showMenuFile || app.showMenuHelp;
 
-        if (IsKeyPressed(KEY_ESCAPE)) { if (app.showMenuFile) app.showMenuFile = false; else if (app.showMenuHelp) app.showMenuHelp = false; else if (app.showSettings) app.showSettings = false; else if (app.showAbout) app.showAbout = false; }
+        if (Input::IsKeyPressed(KEY_ESCAPE)) { if (app.showMenuFile) app.showMenuFile = false; else if (app.showMenuHelp) app.showMenuHelp = false; else if (app.showSettings) app.showSettings = false; else if (app.showAbout) app.showAbout = false; }
 
         Rectangle rFiles = {0,0,0,0}, rTerm = {0,0,0,0}, rEdit = {0,0,0,0};
         Rectangle rResSide = {0,0,0,0}, rResTerm = {0,0,0,0};
@@ -281,8 +342,8 @@ int main() {
             else if (hTerm) SetMouseCursor(settings.layout == LayoutMode::Widescreen ? MOUSE_CURSOR_RESIZE_EW : MOUSE_CURSOR_RESIZE_NS); 
             else SetMouseCursor(MOUSE_CURSOR_DEFAULT);
                 
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { if (hSide) app.resizeSide = true; if (hTerm) app.resizeTerm = true; }
-            if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) { app.resizeSide=false; app.resizeTerm=false; }
+            if (Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { if (hSide) app.resizeSide = true; if (hTerm) app.resizeTerm = true; }
+            if (Input::IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) { app.resizeSide=false; app.resizeTerm=false; }
             
             if (app.resizeSide) { settings.sidebarWidth = Clamp((int)m.x, 150, (int)w - 100); }
             if (app.resizeTerm) {
@@ -292,7 +353,7 @@ int main() {
         }
 
         bool inputCaptured = isModalOpen; 
-        if (!inputCaptured && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { 
+        if (!inputCaptured && Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { 
             if (m.y > headerH && !app.resizeSide && !app.resizeTerm) { 
                 if (settings.showSidebar && CheckCollisionPointRec(m, rFiles) && settings.layout != LayoutMode::Focus) app.focus = 1; 
                 else if (settings.showTerminal && CheckCollisionPointRec(m, rTerm) && settings.layout != LayoutMode::Focus) app.focus = 2; 
@@ -300,15 +361,16 @@ int main() {
             } 
         }
         
-        bool ctrl = IsKeyDown(KEY_LEFT_CONTROL); bool shift = IsKeyDown(KEY_LEFT_SHIFT);
-        if (ctrl && !shift && IsKeyPressed(KEY_O)) { fileMgr.openFileDialog(); app.focus=0; }
-        if (ctrl && shift && IsKeyPressed(KEY_O)) { fileMgr.openFolderDialog(); app.focus=1; }
-        if (ctrl && IsKeyPressed(KEY_B)) settings.showSidebar = !settings.showSidebar; 
-        if (ctrl && IsKeyPressed(KEY_GRAVE)) settings.showTerminal = !settings.showTerminal; 
+        bool ctrl = Input::IsKeyDown(KEY_LEFT_CONTROL); bool shift = Input::IsKeyDown(KEY_LEFT_SHIFT);
+        if (ctrl && !shift && Input::IsKeyPressed(KEY_O)) { fileMgr.openFileDialog(); app.focus=0; }
+        if (ctrl && shift && Input::IsKeyPressed(KEY_O)) { fileMgr.openFolderDialog(); app.focus=1; }
+        if (ctrl && Input::IsKeyPressed(KEY_B)) settings.showSidebar = !settings.showSidebar; 
+        if (ctrl && Input::IsKeyPressed(KEY_GRAVE)) settings.showTerminal = !settings.showTerminal; 
 
         if (!app.showSettings && !app.showAbout) {
             if(settings.showSidebar && settings.layout != LayoutMode::Focus) fileMgr.update(rFiles, app.focus==1 && !app.showMenuFile); 
             std::string sel = fileMgr.popSelectedFile(); if (!sel.empty()) { editor.loadFile(sel); app.focus=0; }
+            std::string folder = fileMgr.popOpenedFolder(); if (!folder.empty()) editor.indexFolder(folder);
             if(settings.showTerminal && settings.layout != LayoutMode::Focus) terminal.update(app.focus==2); 
             editor.update(rEdit, app.focus==0 && !app.showMenuFile && !app.showMenuHelp);
         }
@@ -323,7 +385,7 @@ int main() {
             DrawRectangleRec(rRun, hRun ? theme.runButton : theme.panelBg); DrawRectangleLinesEx(rRun, 1, theme.border);
             DrawTextEx(mainFont, app.runMakefile ? "Run: Make" : "Run: File", {runX+10, 5}, 20, 1, theme.runText);
             
-            if (hRun && IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !isModalOpen) {
+            if (hRun && Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !isModalOpen) {
                 if (app.runMakefile) terminal.runCommand("make");
                 else {
                     std::string path = editor.getCurrentPath();
@@ -338,7 +400,7 @@ int main() {
                 if (!settings.showTerminal) settings.showTerminal = true;
                 app.focus = 2; 
             }
-            if (hRun && IsMouseButtonPressed(MOUSE_RIGHT_BUTTON)) app.runMakefile = !app.runMakefile;
+            if (hRun && Input::IsMouseButtonPressed(MOUSE_RIGHT_BUTTON)) app.runMakefile = !app.runMakefile;
             
             DrawLine(0,headerH,w,headerH,theme.border);
             
@@ -358,30 +420,45 @@ int main() {
             if (settings.layout != LayoutMode::Focus) DrawRectangleLinesEx(rf, 1, BLUE);
 
             if (app.showMenuFile) {
-                float mx=0,my=30,mw=260; DrawRectangle(mx,my,mw,180,theme.panelBg); DrawRectangleLines(mx,my,mw,180,theme.border);
+                float mx=0,my=30,mw=260; DrawRectangle(mx,my,mw,210,theme.panelBg); DrawRectangleLines(mx,my,mw,210,theme.border);
                 if(DrawMenuItem(mx,my,mw,"New (Ctrl+N)",mainFont)) { editor.createNewFile(); app.showMenuFile=false; }
                 if(DrawMenuItem(mx,my+30,mw,"Open File (Ctrl+O)",mainFont)) { fileMgr.openFileDialog(); app.focus=0; app.showMenuFile=false; }
                 if(DrawMenuItem(mx,my+60,mw,"Open Folder (Ctrl+Sh+O)",mainFont)) { fileMgr.openFolderDialog(); app.focus=1; app.showMenuFile=false; }
                 if(DrawMenuItem(mx,my+90,mw,"Save (Ctrl+S)",mainFont)) { editor.saveFile(); app.showMenuFile=false; }
                 if(DrawMenuItem(mx,my+120,mw,"Save As...",mainFont)) { editor.saveAs(); app.showMenuFile=false; }
-                if(DrawMenuItem(mx,my+150,mw,"Exit",mainFont)) break;
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !CheckCollisionPointRec(m, {mx,my,mw,180}) && m.y > 30) app.showMenuFile = false;
+                if(DrawMenuItem(mx,my+150,mw,"Follow File (Ctrl+L)",mainFont)) { editor.toggleFollow(); app.showMenuFile=false; }
+                if(DrawMenuItem(mx,my+180,mw,"Exit",mainFont)) break;
+                if (Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !CheckCollisionPointRec(m, {mx,my,mw,210}) && m.y > 30) app.showMenuFile = false;
             }
             if (app.showMenuHelp) {
                 float mx=60,my=30,mw=300; DrawRectangle(mx,my,mw,130,theme.panelBg); DrawRectangleLines(mx,my,mw,130,theme.border);
                 if(DrawMenuItem(mx,my,mw,"About ctom", mainFont)) OpenModal(app, 2);
                 DrawTextEx(mainFont,"Shortcuts:",{mx+10,my+35},18,1,theme.keyword);
                 DrawTextEx(mainFont,"Ctrl+O/S/C/V/A", {mx+10,my+55},18,1,theme.menuText);
-                DrawTextEx(mainFont,"Ctrl+B / Ctrl+`", {mx+10,my+75},18,1,theme.menuText);
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !CheckCollisionPointRec(m, {mx,my,mw,130}) && m.y > 30) app.showMenuHelp = false;
+                DrawTextEx(mainFont,"Ctrl+B / Ctrl+` / Ctrl+G / Ctrl+M", {mx+10,my+75},18,1,theme.menuText);
+                DrawTextEx(mainFont,"F12 / Ctrl+Click / Ctrl+R / F3", {mx+10,my+95},18,1,theme.menuText);
+                if (Input::IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !CheckCollisionPointRec(m, {mx,my,mw,130}) && m.y > 30) app.showMenuHelp = false;
             }
 
             if (app.showSettings) { DrawRectangle(0,0,w,h,{0,0,0,100}); DrawSettings({(w-700)/2, (h-500)/2, 700, 500}, mainFont, editor, app); }
             if (app.showAbout) { DrawRectangle(0,0,w,h,{0,0,0,100}); DrawAbout({(w-400)/2, (h-250)/2, 400, 250}, mainFont, app, logoTexture); }
             DrawToasts(mainFont, w, h);
+            textBatch.endFrame();
+            session.endFrame();
         EndDrawing();
+        editor.endFrame();
+        frameStats = {ThreadAllocationCount() - frameAllocs, TotalAllocationCount() - allAllocs, frameArena.bytesUsed()};
+        session.frameAllocated(frameStats.allocations);
+        frameArena.reset();
+
+        if (firstFrame) {
+            firstFrame = false;
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launchTime).count();
+            TraceLog(LOG_INFO, "STARTUP: First frame presented after %.1f ms (font atlas %s)", ms, fontCached ? "from cache" : "baking on a worker");
+        }
     }
     
     if (logoTexture.id > 0) UnloadTexture(logoTexture);
-    fileMgr.cleanup(); SaveSettings(); UnloadFont(mainFont); CloseWindow(); return 0;
+    bool passed = session.report(baselinePath); session.close();
+    fileMgr.cleanup(); editor.cleanup(); JobSystem::instance().shutdown(); if (!session.active()) SaveSettings(); if (fontOwned) UnloadFont(mainFont); CloseWindow(); return passed ? 0 : 1;
 }
\ No newline at end of file
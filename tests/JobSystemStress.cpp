@@ -0,0 +1,80 @@
+#include "../include/JobSystem.hpp"
+#include <cstdio>
+
+// Stress test for the job pool, run by make test. Every round submits a mix
+// of interactive and background jobs from the main thread; some of them
+// submit more jobs from their worker, and some rounds cancel part of the work
+// while it is still queued. After waitIdle() every job must have been run or
+// skipped exactly once, no completion of a cancelled job may run, and the
+// background lane must never have held every worker at once.
+
+static constexpr int ROUNDS = 200;
+static constexpr int JOBS_PER_ROUND = 64;
+static constexpr int NESTED_PER_JOB = 3;
+
+static std::atomic<int> backgroundNow{0};
+static std::atomic<int> backgroundPeak{0};
+static std::atomic<int> ran{0};
+static std::atomic<int> nestedSubmitted{0};
+
+static void Spin(int micros) {
+    auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(micros);
+    while (std::chrono::steady_clock::now() < until) {}
+}
+
+static void Work(JobPriority priority, int micros) {
+    if (priority == JobPriority::Background) {
+        int now = ++backgroundNow;
+        int peak = backgroundPeak.load();
+        while (now > peak && !backgroundPeak.compare_exchange_weak(peak, now)) {}
+        Spin(micros);
+        backgroundNow--;
+    } else {
+        Spin(micros);
+    }
+    ran++;
+}
+
+int main() {
+    JobSystem& jobs = JobSystem::instance();
+    int workers = jobs.workerCount();
+    int timings = 0, cancelledTimings = 0, badCompletions = 0;
+    jobs.setTimingHook([&](const JobTiming& t) { timings++; cancelledTimings += t.cancelled; });
+
+    long long submitted = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        CancelSource doomed;
+        bool cancelSome = round % 3 == 0;
+        for (int i = 0; i < JOBS_PER_ROUND; i++) {
+            JobPriority priority = (i % 4 == 0) ? JobPriority::Interactive : JobPriority::Background;
+            bool nested = i % 5 == 0;
+            bool doom = cancelSome && i % 2 == 1;
+            CancelToken token = doom ? doomed.token() : CancelToken();
+            JobSystem::Task done;
+            if (doom) done = [&badCompletions, token]() { if (token.cancelled()) badCompletions++; };
+            jobs.submit("stress", priority, [&jobs, priority, nested]() {
+                Work(priority, 50);
+                if (!nested) return;
+                for (int k = 0; k < NESTED_PER_JOB; k++) {
+                    JobPriority p = k % 2 ? JobPriority::Interactive : JobPriority::Background;
+                    nestedSubmitted++;
+                    jobs.submit("stress.nested", p, [p]() { Work(p, 20); });
+                }
+            }, token, done);
+            submitted++;
+        }
+        if (cancelSome) doomed.cancel();
+        jobs.waitIdle();
+        jobs.drainCompletions();
+    }
+
+    long long expected = submitted + nestedSubmitted;
+    bool ok = true;
+    if (timings != expected) { printf("FAIL: %d jobs reported, %lld submitted\n", timings, expected); ok = false; }
+    if (ran + cancelledTimings != timings) { printf("FAIL: %d ran + %d cancelled != %d reported\n", ran.load(), cancelledTimings, timings); ok = false; }
+    if (badCompletions > 0) { printf("FAIL: %d completions ran for cancelled jobs\n", badCompletions); ok = false; }
+    if (backgroundPeak > workers - 1) { printf("FAIL: %d background jobs ran at once on %d workers\n", backgroundPeak.load(), workers); ok = false; }
+    printf("%s: %d workers, %d jobs (%d cancelled), background peak %d\n", ok ? "PASS" : "FAIL", workers, timings, cancelledTimings, backgroundPeak.load());
+    jobs.shutdown();
+    return ok ? 0 : 1;
+}